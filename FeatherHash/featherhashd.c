@@ -0,0 +1,569 @@
+/* CC0 1.0 Universal - featherhashd.c
+
+ Permission to use, copy, modify, and/or distribute this software for any
+ purpose with or without fee is hereby granted.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+ Minimal local hashing daemon. Listens on a UNIX domain socket and hashes
+ paths, passed descriptors or inline bytes on a fixed pool of worker threads.
+
+ Usage: featherhashd [-s SOCKET] [-w WORKERS] [-v]
+*/
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE 1
+#endif /* !_DEFAULT_SOURCE */
+#ifndef _DARWIN_C_SOURCE
+#define _DARWIN_C_SOURCE 1
+#endif /* !_DARWIN_C_SOURCE */
+
+#include "sha2.h"
+#include "featherhashd.h"
+#include "featherio.h"
+#include "feather.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif /* !MSG_NOSIGNAL */
+#ifndef MSG_CMSG_CLOEXEC
+#define MSG_CMSG_CLOEXEC 0
+#endif /* !MSG_CMSG_CLOEXEC */
+
+/* Pending requests held between the acceptor and the workers. */
+#define FHD_QUEUE_MAX 256
+/* Inline (FHD_OP_BYTES) requests a worker takes per trip to the queue. */
+#define FHD_BATCH_MAX 16
+/* Connections whose request is still arriving, and how long each may take. */
+#define FHD_PENDING_MAX 128
+#define FHD_REQUEST_TIMEOUT_SEC 5
+/* Poll interval for shutdown and request timeouts. */
+#define FHD_POLL_MS 500
+/* Per-worker read buffer for paths and descriptors. */
+#define FHD_READ_BUF (64u * 1024u)
+#define FHD_WORKERS_MAX 64
+
+static const uint64_t SHA384_IV[8] = {
+	0xcbbb9d5dc1059ed8ULL,0x629a292a367cd507ULL,0x9159015a3070dd17ULL,0x152fecd8f70e5939ULL,
+	0x67332667ffc00b31ULL,0x8eb44a8768581511ULL,0xdb0c2e0d64f98fa7ULL,0x47b5481dbefa4fa4ULL
+};
+
+static const uint64_t SHA512_IV[8] = {
+	0x6a09e667f3bcc908ULL,0xbb67ae8584caa73bULL,0x3c6ef372fe94f82bULL,0xa54ff53a5f1d36f1ULL,
+	0x510e527fade682d1ULL,0x9b05688c2b3e6c1fULL,0x1f83d9abfb41bd6bULL,0x5be0cd19137e2179ULL
+};
+
+typedef struct {
+	int conn;          /* client connection; the reply is written here */
+	int fd;            /* descriptor received with FHD_OP_FD, else -1 */
+	uint8_t op;
+	uint8_t alg;
+	uint32_t len;
+	uint8_t *payload;  /* path (NUL terminated) or inline bytes */
+} fhd_job;
+
+static struct {
+	pthread_mutex_t lock;
+	pthread_cond_t nonempty;
+	fhd_job jobs[FHD_QUEUE_MAX];
+	size_t head;
+	size_t count;
+	int stopping;
+} queue = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, { { 0 } }, 0, 0, 0 };
+
+static volatile sig_atomic_t stop_requested = 0;
+static int verbose = 0;
+
+static void on_signal(int sig) {
+	(void)sig;
+	stop_requested = 1;
+}
+
+#if defined(__clang__) && __clang__
+#pragma mark -
+#pragma mark Hashing
+#endif /* !__clang__ */
+
+typedef struct {
+	uint8_t alg;
+	union {
+		sha256_ctx s256;
+		sha512_ctx s512;
+	} u;
+} fhd_hash;
+
+static void fhd_hash_init(fhd_hash *h, uint8_t alg) {
+	h->alg = alg;
+	if (alg == FHD_ALG_SHA256) sha256_init(&h->u.s256);
+	else sha512_init(&h->u.s512, (alg == FHD_ALG_SHA384) ? SHA384_IV : SHA512_IV);
+}
+
+static void fhd_hash_update(void *ctx, const void *data, size_t len) {
+	fhd_hash *h = (fhd_hash *)ctx;
+	if (h->alg == FHD_ALG_SHA256) sha256_update(&h->u.s256, data, len);
+	else sha512_update(&h->u.s512, data, len);
+}
+
+static void fhd_hash_zeros(void *ctx, uint64_t len) {
+	fhd_hash *h = (fhd_hash *)ctx;
+	if (h->alg == FHD_ALG_SHA256) sha256_update_zeros(&h->u.s256, len);
+	else sha512_update_zeros(&h->u.s512, len);
+}
+
+static void fhd_hash_final(fhd_hash *h, uint8_t out[64]) {
+	if (h->alg == FHD_ALG_SHA256) sha256_final(&h->u.s256, out);
+	else sha512_final(&h->u.s512, out);
+}
+
+/*
+ Hash `fd` to EOF. Regular files go through fh_hash_fd (sparse-aware, never block for long);
+ anything else may block indefinitely, so it is read only when poll reports data, and the job is
+ abandoned as soon as the client connection hangs up or the daemon is stopping.
+ */
+static int fhd_hash_stream(fhd_hash *h, int fd, int conn, uint8_t *buf) {
+	struct stat st;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+		fh_sink sink = { h, fhd_hash_update, fhd_hash_zeros };
+		return (fh_hash_fd(fd, &sink, buf, FHD_READ_BUF) == 0) ? FHD_OK : FHD_ERR_READ;
+	}
+	for (;;) {
+		struct pollfd pfd[2] = { { fd, POLLIN, 0 }, { conn, 0, 0 } };
+		int pr = poll(pfd, 2, FHD_POLL_MS);
+		if (pr < 0 && errno != EINTR) return FHD_ERR_READ;
+		if (pfd[1].revents & (POLLHUP | POLLERR | POLLNVAL)) return FHD_ERR_READ; /* client gone */
+		if (stop_requested) return FHD_ERR_READ;
+		if (pr <= 0 || pfd[0].revents == 0) continue;
+		ssize_t r = read(fd, buf, FHD_READ_BUF);
+		if (r == 0) return FHD_OK;
+		if (r < 0) {
+			if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) continue;
+			return FHD_ERR_READ;
+		}
+		fhd_hash_update(h, buf, (size_t)r);
+	}
+}
+
+/*
+ Tell the client that a worker has taken its path or descriptor job. Until this arrives the client may
+ time out and hash locally, so a job whose client has already hung up is dropped unread.
+ */
+static int fhd_job_start(const fhd_job *job) {
+	struct pollfd pfd = { job->conn, 0, 0 };
+	if (poll(&pfd, 1, 0) < 0 || (pfd.revents & (POLLHUP | POLLERR | POLLNVAL))) return -1;
+	fhd_response resp;
+	memset(&resp, 0, sizeof(resp));
+	resp.magic = FHD_MAGIC;
+	resp.status = FHD_STARTED;
+	return (send(job->conn, &resp, sizeof(resp), MSG_NOSIGNAL) == (ssize_t)sizeof(resp)) ? 0 : -1;
+}
+
+static void fhd_run_job(fhd_job *job, uint8_t *buf) {
+	fhd_response resp;
+	memset(&resp, 0, sizeof(resp));
+	resp.magic = FHD_MAGIC;
+	fhd_hash h;
+	fhd_hash_init(&h, job->alg);
+	int status = FHD_OK;
+	switch (job->op) {
+		case FHD_OP_BYTES:
+			fhd_hash_update(&h, job->payload, job->len);
+			break;
+		case FHD_OP_FD:
+			if (fhd_job_start(job) != 0) {
+				status = FHD_ERR_READ;
+				break;
+			}
+			status = fhd_hash_stream(&h, job->fd, job->conn, buf);
+			break;
+		case FHD_OP_PATH: {
+			if (fhd_job_start(job) != 0) {
+				status = FHD_ERR_READ;
+				break;
+			}
+			/* O_NONBLOCK so a FIFO without a writer cannot hang the open */
+			int fd = open((const char *)job->payload, O_RDONLY | O_NONBLOCK);
+			if (fd < 0) {
+				status = FHD_ERR_OPEN;
+				break;
+			}
+			(void)fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+			status = fhd_hash_stream(&h, fd, job->conn, buf);
+			close(fd);
+			break;
+		}
+		default:
+			status = FHD_ERR_PROTO;
+			break;
+	}
+	uint8_t digest[64];
+	fhd_hash_final(&h, digest);
+	resp.status = status;
+	if (status == FHD_OK) {
+		resp.digest_len = (uint32_t)fhd_digest_len(job->alg);
+		memcpy(resp.digest, digest, resp.digest_len);
+	}
+	if (verbose) fprintf(stderr, "featherhashd: op=%u alg=%u len=%u status=%d\n",
+		(unsigned)job->op, (unsigned)job->alg, (unsigned)job->len, status);
+	(void)send(job->conn, &resp, sizeof(resp), MSG_NOSIGNAL);
+}
+
+static void fhd_job_release(fhd_job *job) {
+	if (job->fd >= 0) close(job->fd);
+	if (job->conn >= 0) close(job->conn);
+	free(job->payload);
+	job->payload = NULL;
+}
+
+#if defined(__clang__) && __clang__
+#pragma mark -
+#pragma mark Worker Pool
+#endif /* !__clang__ */
+
+/* Never blocks the acceptor: returns -1 if the queue is full or the daemon is stopping. */
+static int fhd_enqueue(const fhd_job *job) {
+	pthread_mutex_lock(&queue.lock);
+	if (queue.count == FHD_QUEUE_MAX || queue.stopping) {
+		pthread_mutex_unlock(&queue.lock);
+		return -1;
+	}
+	queue.jobs[(queue.head + queue.count) % FHD_QUEUE_MAX] = *job;
+	queue.count++;
+	pthread_cond_signal(&queue.nonempty);
+	pthread_mutex_unlock(&queue.lock);
+	return 0;
+}
+
+/*
+ Takes one streaming job, or a run of up to `max` consecutive inline jobs, so long streams are
+ spread over the pool instead of queueing behind each other on one worker.
+ Returns 0 only once stopping and drained.
+ */
+static size_t fhd_dequeue_batch(fhd_job *out, size_t max) {
+	pthread_mutex_lock(&queue.lock);
+	while (queue.count == 0 && !queue.stopping) pthread_cond_wait(&queue.nonempty, &queue.lock);
+	size_t n = 0;
+	while (n < max && queue.count > 0) {
+		const fhd_job *next = &queue.jobs[queue.head];
+		if (n > 0 && next->op != FHD_OP_BYTES) break;
+		out[n++] = *next;
+		queue.head = (queue.head + 1) % FHD_QUEUE_MAX;
+		queue.count--;
+		if (out[n - 1].op != FHD_OP_BYTES) break;
+	}
+	pthread_mutex_unlock(&queue.lock);
+	return n;
+}
+
+static void *fhd_worker(void *arg) {
+	(void)arg;
+	uint8_t *buf = (uint8_t *)malloc(FHD_READ_BUF);
+	if (!buf) return NULL;
+	fhd_job batch[FHD_BATCH_MAX];
+	size_t n;
+	while ((n = fhd_dequeue_batch(batch, FHD_BATCH_MAX)) > 0) {
+		for (size_t i = 0; i < n; ++i) {
+			fhd_run_job(&batch[i], buf);
+			fhd_job_release(&batch[i]);
+		}
+	}
+	free(buf);
+	return NULL;
+}
+
+#if defined(__clang__) && __clang__
+#pragma mark -
+#pragma mark Connections
+#endif /* !__clang__ */
+
+static void fhd_reply_error(int conn, int status) {
+	fhd_response resp;
+	memset(&resp, 0, sizeof(resp));
+	resp.magic = FHD_MAGIC;
+	resp.status = status;
+	(void)send(conn, &resp, sizeof(resp), MSG_NOSIGNAL);
+}
+
+/* A connection whose request has not fully arrived; read without blocking by the acceptor. */
+typedef struct {
+	fhd_job job;
+	fhd_request req;
+	size_t got;        /* bytes of header + payload received so far */
+	time_t deadline;
+} fhd_pending;
+
+static time_t fhd_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec;
+}
+
+static void fhd_pending_open(fhd_pending *p, int conn) {
+	struct timeval tv = { FHD_REQUEST_TIMEOUT_SEC, 0 };
+	(void)setsockopt(conn, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+#if defined(SO_NOSIGPIPE)
+	int one = 1;
+	(void)setsockopt(conn, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif /* !SO_NOSIGPIPE */
+	memset(p, 0, sizeof(*p));
+	p->job.conn = conn;
+	p->job.fd = -1;
+	p->deadline = fhd_now() + FHD_REQUEST_TIMEOUT_SEC;
+}
+
+/* Validate a complete header and allocate the payload buffer. */
+static int fhd_pending_header(fhd_pending *p) {
+	const fhd_request *req = &p->req;
+	int ok = req->magic == FHD_MAGIC && req->reserved == 0 && fhd_digest_len(req->alg) != 0 && req->len <= FHD_MAX_PAYLOAD;
+	if (req->op == FHD_OP_FD) ok = ok && p->job.fd >= 0 && req->len == 0;
+	else if (req->op == FHD_OP_PATH) ok = ok && req->len > 0;
+	else if (req->op != FHD_OP_BYTES) ok = 0;
+	if (!ok) return -1;
+	p->job.op = req->op;
+	p->job.alg = req->alg;
+	p->job.len = req->len;
+	if (req->len > 0) {
+		p->job.payload = (uint8_t *)malloc((size_t)req->len + 1);
+		if (!p->job.payload) return -1;
+	}
+	return 0;
+}
+
+/*
+ Consume whatever the client has sent so far without blocking.
+ Returns 1 once the request is complete, 0 if more is expected, -1 on EOF or a bad request.
+ */
+static int fhd_pending_read(fhd_pending *p) {
+	for (;;) {
+		ssize_t r;
+		if (p->got < sizeof(p->req)) {
+			union {
+				struct cmsghdr align;
+				char buf[CMSG_SPACE(sizeof(int) * 4)];
+			} ctl;
+			struct iovec iov = { (uint8_t *)&p->req + p->got, sizeof(p->req) - p->got };
+			struct msghdr msg;
+			memset(&msg, 0, sizeof(msg));
+			msg.msg_iov = &iov;
+			msg.msg_iovlen = 1;
+			msg.msg_control = ctl.buf;
+			msg.msg_controllen = sizeof(ctl.buf);
+			r = recvmsg(p->job.conn, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+			for (struct cmsghdr *cm = (r > 0) ? CMSG_FIRSTHDR(&msg) : NULL; cm; cm = CMSG_NXTHDR(&msg, cm)) {
+				if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_RIGHTS) continue;
+				size_t nfds = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+				for (size_t i = 0; i < nfds; ++i) {
+					int fd;
+					memcpy(&fd, CMSG_DATA(cm) + i * sizeof(int), sizeof(int));
+					if (p->job.fd < 0) p->job.fd = fd;
+					else close(fd);
+				}
+			}
+		} else {
+			size_t off = p->got - sizeof(p->req);
+			r = recv(p->job.conn, p->job.payload + off, p->job.len - off, MSG_DONTWAIT);
+		}
+		if (r < 0) {
+			if (errno == EINTR) continue;
+			return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+		}
+		if (r == 0) return -1;
+		int in_header = p->got < sizeof(p->req);
+		p->got += (size_t)r;
+		if (in_header && p->got == sizeof(p->req) && fhd_pending_header(p) != 0) {
+			fhd_reply_error(p->job.conn, FHD_ERR_PROTO);
+			return -1;
+		}
+		if (p->got == sizeof(p->req) + p->job.len) break;
+	}
+	if (p->job.len > 0) {
+		p->job.payload[p->job.len] = 0;
+		/* an embedded NUL would silently hash a different path */
+		if (p->job.op == FHD_OP_PATH && memchr(p->job.payload, 0, p->job.len) != NULL) {
+			fhd_reply_error(p->job.conn, FHD_ERR_PROTO);
+			return -1;
+		}
+	}
+	return 1;
+}
+
+/*
+ Make `path` free to bind. Only a stale socket (one nothing accepts on any more) is removed; a live
+ daemon's socket or anything that is not a socket is left alone and the start is refused.
+ */
+static int fhd_claim_path(const char *path, const struct sockaddr_un *sa) {
+	struct stat st;
+	if (lstat(path, &st) != 0) {
+		if (errno == ENOENT) return 0;
+		fprintf(stderr, "featherhashd: %s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	if (!S_ISSOCK(st.st_mode)) {
+		fprintf(stderr, "featherhashd: %s: exists and is not a socket\n", path);
+		return -1;
+	}
+	int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (probe < 0) {
+		perror("featherhashd: socket");
+		return -1;
+	}
+	int rc = connect(probe, (const struct sockaddr *)sa, sizeof(*sa));
+	int err = errno;
+	close(probe);
+	if (rc == 0 || err != ECONNREFUSED) {
+		fprintf(stderr, "featherhashd: %s: socket is in use by another daemon\n", path);
+		return -1;
+	}
+	if (unlink(path) != 0 && errno != ENOENT) {
+		fprintf(stderr, "featherhashd: %s: cannot remove stale socket: %s\n", path, strerror(errno));
+		return -1;
+	}
+	return 0;
+}
+
+/* Bind and listen on `path`; `bound` receives the identity of the socket file created. */
+static int fhd_listen(const char *path, struct stat *bound) {
+	struct sockaddr_un sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(sa.sun_path)) {
+		fprintf(stderr, "featherhashd: %s: socket path too long\n", path);
+		return -1;
+	}
+	memcpy(sa.sun_path, path, strlen(path) + 1);
+	if (fhd_claim_path(path, &sa) != 0) return -1;
+	int s = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (s < 0) {
+		perror("featherhashd: socket");
+		return -1;
+	}
+	mode_t old = umask(0177);
+	int rc = bind(s, (const struct sockaddr *)&sa, sizeof(sa));
+	umask(old);
+	if (rc != 0 || listen(s, 128) != 0 || lstat(path, bound) != 0) {
+		fprintf(stderr, "featherhashd: %s: cannot bind/listen: %s\n", path, strerror(errno));
+		close(s);
+		return -1;
+	}
+	return s;
+}
+
+/* Remove `path` only if it is still the socket this process bound. */
+static void fhd_unlink_own(const char *path, const struct stat *bound) {
+	struct stat st;
+	if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode) && st.st_dev == bound->st_dev && st.st_ino == bound->st_ino) {
+		(void)unlink(path);
+	}
+}
+
+static void usage(void) {
+	fprintf(stderr, "usage: featherhashd [-s SOCKET] [-w WORKERS] [-v]\n");
+}
+
+int main(int argc, char **argv) {
+	const char *path = getenv(FHD_SOCKET_ENV);
+	if (!path || !*path) path = FHD_DEFAULT_SOCKET;
+	long workers = sysconf(_SC_NPROCESSORS_ONLN);
+	int opt;
+	while ((opt = getopt(argc, argv, "s:w:vh")) != -1) {
+		switch (opt) {
+			case 's': path = optarg; break;
+			case 'w': workers = strtol(optarg, NULL, 10); break;
+			case 'v': verbose = 1; break;
+			default: usage(); return (opt == 'h') ? 0 : 2;
+		}
+	}
+	if (workers < 1) workers = 1;
+	if (workers > FHD_WORKERS_MAX) workers = FHD_WORKERS_MAX;
+
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = on_signal;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	sa.sa_handler = SIG_IGN;
+	sigaction(SIGPIPE, &sa, NULL);
+
+	struct stat bound;
+	int ls = fhd_listen(path, &bound);
+	if (ls < 0) return 1;
+
+	pthread_t pool[FHD_WORKERS_MAX];
+	long started = 0;
+	for (; started < workers; ++started) {
+		if (pthread_create(&pool[started], NULL, fhd_worker, NULL) != 0) break;
+	}
+	if (started == 0) {
+		fprintf(stderr, "featherhashd: cannot start workers\n");
+		close(ls);
+		fhd_unlink_own(path, &bound);
+		return 1;
+	}
+	if (verbose) fprintf(stderr, "featherhashd: listening on %s with %ld workers\n", path, started);
+
+	/* The acceptor never blocks on a client: requests are assembled from whatever has arrived. */
+	static fhd_pending pending[FHD_PENDING_MAX];
+	struct pollfd pfds[FHD_PENDING_MAX + 1];
+	size_t npending = 0;
+	while (!stop_requested) {
+		pfds[0].fd = ls;
+		pfds[0].events = (npending < FHD_PENDING_MAX) ? POLLIN : 0;
+		pfds[0].revents = 0;
+		for (size_t i = 0; i < npending; ++i) {
+			pfds[i + 1].fd = pending[i].job.conn;
+			pfds[i + 1].events = POLLIN;
+			pfds[i + 1].revents = 0;
+		}
+		int pr = poll(pfds, (nfds_t)(npending + 1), FHD_POLL_MS);
+		if (pr < 0) continue;
+		time_t now = fhd_now();
+		/* walk backwards so removing entry i (swap with the last) keeps pfds[] in step */
+		for (size_t i = npending; i-- > 0;) {
+			int done = 0;
+			if (pfds[i + 1].revents) done = fhd_pending_read(&pending[i]);
+			else if (now >= pending[i].deadline) done = -1;
+			if (done == 0) continue;
+			if (done > 0 && fhd_enqueue(&pending[i].job) != 0) {
+				fhd_reply_error(pending[i].job.conn, FHD_ERR_BUSY);
+				done = -1;
+			}
+			if (done < 0) fhd_job_release(&pending[i].job);
+			pending[i] = pending[--npending];
+			pfds[i + 1] = pfds[npending + 1];
+		}
+		if (pfds[0].revents & POLLIN) {
+			int conn = accept(ls, NULL, NULL);
+			if (conn >= 0) {
+				(void)fcntl(conn, F_SETFD, FD_CLOEXEC);
+				fhd_pending_open(&pending[npending++], conn);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < npending; ++i) fhd_job_release(&pending[i].job);
+	close(ls);
+	fhd_unlink_own(path, &bound);
+	pthread_mutex_lock(&queue.lock);
+	queue.stopping = 1;
+	pthread_cond_broadcast(&queue.nonempty);
+	pthread_mutex_unlock(&queue.lock);
+	for (long i = 0; i < started; ++i) pthread_join(pool[i], NULL);
+	return 0;
+}
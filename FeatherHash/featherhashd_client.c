@@ -0,0 +1,176 @@
+/* CC0 1.0 Universal - featherhashd_client.c
+
+ Permission to use, copy, modify, and/or distribute this software for any
+ purpose with or without fee is hereby granted.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+ Thin client for featherhashd, linked into the sha*sum utilities.
+*/
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE 1
+#endif /* !_DEFAULT_SOURCE */
+#ifndef _DARWIN_C_SOURCE
+#define _DARWIN_C_SOURCE 1
+#endif /* !_DARWIN_C_SOURCE */
+
+#include "featherhashd.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif /* !MSG_NOSIGNAL */
+
+/* How long to wait for the daemon to take a request before hashing locally. */
+#define FHD_CLIENT_TIMEOUT_SEC 5
+
+size_t fhd_digest_len(uint8_t alg) {
+	switch (alg) {
+		case FHD_ALG_SHA256: return 32;
+		case FHD_ALG_SHA384: return 48;
+		case FHD_ALG_SHA512: return 64;
+		default: return 0;
+	}
+}
+
+static int fhd_connect(void) {
+	const char *path = getenv(FHD_SOCKET_ENV);
+	if (!path || !*path) return -1;
+	struct sockaddr_un sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(sa.sun_path)) return -1;
+	memcpy(sa.sun_path, path, strlen(path) + 1);
+	int s = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (s < 0) return -1;
+	struct timeval tv = { FHD_CLIENT_TIMEOUT_SEC, 0 };
+	(void)setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+	(void)setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+#if defined(SO_NOSIGPIPE)
+	int one = 1;
+	(void)setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif /* !SO_NOSIGPIPE */
+	if (connect(s, (const struct sockaddr *)&sa, sizeof(sa)) != 0) {
+		close(s);
+		return -1;
+	}
+	return s;
+}
+
+static int fhd_send_all(int s, const void *data, size_t len) {
+	const uint8_t *p = (const uint8_t *)data;
+	while (len > 0) {
+		ssize_t w = send(s, p, len, MSG_NOSIGNAL);
+		if (w < 0) {
+			if (errno == EINTR) continue;
+			return -1;
+		}
+		p += w;
+		len -= (size_t)w;
+	}
+	return 0;
+}
+
+static int fhd_recv_all(int s, void *data, size_t len) {
+	uint8_t *p = (uint8_t *)data;
+	while (len > 0) {
+		ssize_t r = recv(s, p, len, 0);
+		if (r < 0 && errno == EINTR) continue;
+		if (r <= 0) return -1;
+		p += r;
+		len -= (size_t)r;
+	}
+	return 0;
+}
+
+/* Send one request (optionally carrying fd) and wait for the response. */
+static int fhd_roundtrip(const fhd_request *req, const void *payload, int pass_fd, uint8_t *out, size_t outlen) {
+	size_t want = fhd_digest_len(req->alg);
+	if (want == 0 || outlen < want) return FHD_UNAVAILABLE;
+	int s = fhd_connect();
+	if (s < 0) return FHD_UNAVAILABLE;
+	int sent;
+	if (pass_fd >= 0) {
+		union {
+			struct cmsghdr align;
+			char buf[CMSG_SPACE(sizeof(int))];
+		} ctl;
+		memset(&ctl, 0, sizeof(ctl));
+		struct iovec iov = { (void *)req, sizeof(*req) };
+		struct msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = ctl.buf;
+		msg.msg_controllen = sizeof(ctl.buf);
+		struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+		cm->cmsg_level = SOL_SOCKET;
+		cm->cmsg_type = SCM_RIGHTS;
+		cm->cmsg_len = CMSG_LEN(sizeof(int));
+		memcpy(CMSG_DATA(cm), &pass_fd, sizeof(int));
+		ssize_t w;
+		do {
+			w = sendmsg(s, &msg, MSG_NOSIGNAL);
+		} while (w < 0 && errno == EINTR);
+		sent = (w == (ssize_t)sizeof(*req)) ? 0 : -1;
+	} else {
+		sent = fhd_send_all(s, req, sizeof(*req));
+		if (sent == 0 && req->len > 0) sent = fhd_send_all(s, payload, req->len);
+	}
+	if (sent != 0) {
+		close(s);
+		return FHD_UNAVAILABLE;
+	}
+	fhd_response resp;
+	int started = 0;
+	for (;;) {
+		if (fhd_recv_all(s, &resp, sizeof(resp)) != 0 || resp.magic != FHD_MAGIC) {
+			close(s);
+			/* once a worker has started on a descriptor its offset may have moved */
+			return (started && pass_fd >= 0) ? FHD_ERR_READ : FHD_UNAVAILABLE;
+		}
+		if (resp.status != FHD_STARTED || started) break;
+		/* the job is running; wait for it however long the stream takes */
+		struct timeval tv = { 0, 0 };
+		(void)setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+		started = 1;
+	}
+	close(s);
+	if (resp.status == FHD_ERR_BUSY) return FHD_UNAVAILABLE;
+	if (resp.status != FHD_OK) return resp.status > 0 ? resp.status : FHD_ERR_PROTO;
+	if (resp.digest_len != want) return FHD_ERR_PROTO;
+	memcpy(out, resp.digest, want);
+	return 0;
+}
+
+int fhd_hash_fd(uint8_t alg, int fd, uint8_t *out, size_t outlen) {
+	if (fd < 0) return FHD_UNAVAILABLE;
+	fhd_request req = { FHD_MAGIC, FHD_OP_FD, alg, 0, 0 };
+	return fhd_roundtrip(&req, NULL, fd, out, outlen);
+}
+
+int fhd_hash_path(uint8_t alg, const char *path, uint8_t *out, size_t outlen) {
+	size_t len = path ? strlen(path) : 0;
+	if (len == 0 || len > FHD_MAX_PAYLOAD) return FHD_UNAVAILABLE;
+	fhd_request req = { FHD_MAGIC, FHD_OP_PATH, alg, 0, (uint32_t)len };
+	return fhd_roundtrip(&req, path, -1, out, outlen);
+}
+
+int fhd_hash_bytes(uint8_t alg, const void *data, size_t len, uint8_t *out, size_t outlen) {
+	if (len > FHD_MAX_PAYLOAD || (len > 0 && !data)) return FHD_UNAVAILABLE;
+	fhd_request req = { FHD_MAGIC, FHD_OP_BYTES, alg, 0, (uint32_t)len };
+	return fhd_roundtrip(&req, data, -1, out, outlen);
+}
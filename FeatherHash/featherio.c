@@ -0,0 +1,350 @@
+/* CC0 1.0 Universal - featherio.c
+
+ Permission to use, copy, modify, and/or distribute this software for any
+ purpose with or without fee is hereby granted.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+ Shared input handling for the sha*sum utilities and featherhashd.
+*/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1 /* SEEK_DATA / SEEK_HOLE and tee(2) on glibc */
+#endif /* !_GNU_SOURCE */
+#ifndef _DARWIN_C_SOURCE
+#define _DARWIN_C_SOURCE 1
+#endif /* !_DARWIN_C_SOURCE */
+
+#include "featherio.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FH_PIPE_BUFFERS_MAX 64
+#define FH_PIPE_BUFSIZE_MIN 4096u
+#define FH_PIPE_BUFSIZE_MAX (64u * 1024u * 1024u)
+/* Upper bound on the whole ring; small enough for 32-bit address spaces. */
+#define FH_PIPE_RING_MAX (256u * 1024u * 1024u)
+
+/* Read [*pos, end) (or to EOF when end is negative) into sink. */
+static int fh_read_range(int fd, const fh_sink *sink, uint8_t *buf, size_t bufsize, off_t *pos, off_t end) {
+	for (;;) {
+		size_t want = bufsize;
+		if (end >= 0) {
+			if (*pos >= end) return 0;
+			if ((uint64_t)(end - *pos) < (uint64_t)want) want = (size_t)(end - *pos);
+		}
+		ssize_t r = read(fd, buf, want);
+		if (r == 0) return 0;
+		if (r < 0) {
+			if (errno == EINTR) continue;
+			return -1;
+		}
+		sink->update(sink->ctx, buf, (size_t)r);
+		*pos += r;
+	}
+}
+
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+/*
+ Walk the data extents of a sparse regular file. Returns 1 if the platform or
+ filesystem cannot report extents and nothing has been consumed yet.
+ */
+static int fh_hash_sparse(int fd, const fh_sink *sink, uint8_t *buf, size_t bufsize, off_t pos, off_t size) {
+	int first = 1;
+	while (pos < size) {
+		off_t data = lseek(fd, pos, SEEK_DATA);
+		if (data < 0) {
+			if (errno == ENXIO) data = size; /* only a hole remains */
+			else if (first) return 1;
+			else return -1;
+		}
+		if (data > size) data = size;
+		first = 0;
+		if (data > pos) {
+			sink->zeros(sink->ctx, (uint64_t)(data - pos));
+			pos = data;
+		}
+		if (pos >= size) break;
+		off_t hole = lseek(fd, pos, SEEK_HOLE);
+		if (hole < 0 || hole > size) hole = size;
+		if (lseek(fd, pos, SEEK_SET) < 0) return -1;
+		if (fh_read_range(fd, sink, buf, bufsize, &pos, hole) != 0) return -1;
+		if (pos < hole) return 0; /* truncated underneath us: EOF came early */
+	}
+	/* anything appended since fstat is read normally */
+	if (lseek(fd, pos, SEEK_SET) < 0) return -1;
+	return fh_read_range(fd, sink, buf, bufsize, &pos, -1);
+}
+#endif /* !SEEK_DATA */
+
+int fh_hash_fd(int fd, const fh_sink *sink, uint8_t *buf, size_t bufsize) {
+	off_t pos = 0;
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+	struct stat st;
+	/* only files with fewer allocated blocks than their size can have holes */
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+		(uint64_t)st.st_blocks * 512u < (uint64_t)st.st_size) {
+		pos = lseek(fd, 0, SEEK_CUR);
+		if (pos >= 0 && pos < st.st_size) {
+			int r = fh_hash_sparse(fd, sink, buf, bufsize, pos, st.st_size);
+			if (r <= 0) return r;
+		}
+		if (pos < 0) pos = 0;
+	}
+#endif /* !SEEK_DATA */
+	return fh_read_range(fd, sink, buf, bufsize, &pos, -1);
+}
+
+/* Parse a positive count with an optional K/M suffix; returns `dflt` if unset or malformed. */
+static size_t fh_env_size(const char *name, size_t dflt) {
+	const char *v = getenv(name);
+	if (!v || !*v) return dflt;
+	char *end = NULL;
+	unsigned long long n = strtoull(v, &end, 10);
+	if (end == v) return dflt;
+	if (*end == 'k' || *end == 'K') { n *= 1024u; ++end; }
+	else if (*end == 'm' || *end == 'M') { n *= 1024u * 1024u; ++end; }
+	if (*end != '\0' || n > SIZE_MAX) return dflt;
+	return (size_t)n;
+}
+
+typedef struct {
+	int fd;
+	uint8_t *ring;
+	size_t nbufs;
+	size_t bufsize;
+	size_t *lens;
+	size_t head;      /* next buffer the reader fills */
+	size_t tail;      /* next buffer the hasher consumes */
+	size_t filled;    /* buffers ready for the hasher */
+	int eof;
+	int err;          /* errno of a failed read, 0 otherwise */
+	pthread_mutex_t lock;
+	pthread_cond_t ready;
+	pthread_cond_t freed;
+} fh_ring;
+
+/* Fill free buffers until EOF or error. Each buffer is filled completely (or up to EOF)
+ before it is handed over, which keeps hand-offs rare while pipe reads stay small. */
+static void *fh_ring_reader(void *arg) {
+	fh_ring *r = (fh_ring *)arg;
+	for (;;) {
+		pthread_mutex_lock(&r->lock);
+		while (r->filled == r->nbufs) pthread_cond_wait(&r->freed, &r->lock);
+		size_t slot = r->head;
+		pthread_mutex_unlock(&r->lock);
+
+		uint8_t *b = r->ring + slot * r->bufsize;
+		size_t len = 0;
+		int eof = 0, err = 0;
+		while (len < r->bufsize) {
+			ssize_t n = read(r->fd, b + len, r->bufsize - len);
+			if (n > 0) {
+				len += (size_t)n;
+				continue;
+			}
+			if (n == 0) eof = 1;
+			else if (errno == EINTR) continue;
+			else err = errno;
+			break;
+		}
+
+		pthread_mutex_lock(&r->lock);
+		if (len > 0) {
+			r->lens[slot] = len;
+			r->head = (slot + 1) % r->nbufs;
+			++r->filled;
+		}
+		r->eof = eof || err;
+		r->err = err;
+		pthread_cond_signal(&r->ready);
+		pthread_mutex_unlock(&r->lock);
+		if (eof || err) return NULL;
+	}
+}
+
+int fh_hash_fd_overlapped(int fd, const fh_sink *sink, uint8_t *buf, size_t bufsize) {
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !(S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode)))
+		return fh_hash_fd(fd, sink, buf, bufsize);
+
+	fh_ring r = { 0 };
+	r.fd = fd;
+	r.nbufs = fh_env_size(FH_PIPE_BUFFERS_ENV, FH_PIPE_BUFFERS_DEFAULT);
+	r.bufsize = fh_env_size(FH_PIPE_BUFSIZE_ENV, FH_PIPE_BUFSIZE_DEFAULT);
+	if (r.nbufs < 2) return fh_hash_fd(fd, sink, buf, bufsize);
+	if (r.nbufs > FH_PIPE_BUFFERS_MAX) r.nbufs = FH_PIPE_BUFFERS_MAX;
+	if (r.bufsize < FH_PIPE_BUFSIZE_MIN) r.bufsize = FH_PIPE_BUFSIZE_MIN;
+	if (r.bufsize > FH_PIPE_BUFSIZE_MAX) r.bufsize = FH_PIPE_BUFSIZE_MAX;
+	/* fewer buffers rather than a ring over the cap; also keeps nbufs * bufsize from wrapping */
+	if (r.nbufs > FH_PIPE_RING_MAX / r.bufsize) r.nbufs = FH_PIPE_RING_MAX / r.bufsize;
+	if (r.nbufs < 2 || r.nbufs > SIZE_MAX / r.bufsize) return fh_hash_fd(fd, sink, buf, bufsize);
+
+	r.ring = (uint8_t *)malloc(r.nbufs * r.bufsize);
+	r.lens = (size_t *)calloc(r.nbufs, sizeof(*r.lens));
+	if (!r.ring || !r.lens) {
+		free(r.ring);
+		free(r.lens);
+		return fh_hash_fd(fd, sink, buf, bufsize);
+	}
+	pthread_mutex_init(&r.lock, NULL);
+	pthread_cond_init(&r.ready, NULL);
+	pthread_cond_init(&r.freed, NULL);
+
+	pthread_t tid;
+	int rc;
+	if (pthread_create(&tid, NULL, fh_ring_reader, &r) != 0) {
+		rc = fh_hash_fd(fd, sink, buf, bufsize);
+	} else {
+		for (;;) {
+			pthread_mutex_lock(&r.lock);
+			while (r.filled == 0 && !r.eof) pthread_cond_wait(&r.ready, &r.lock);
+			if (r.filled == 0) {
+				pthread_mutex_unlock(&r.lock);
+				break;
+			}
+			size_t slot = r.tail;
+			pthread_mutex_unlock(&r.lock);
+
+			sink->update(sink->ctx, r.ring + slot * r.bufsize, r.lens[slot]);
+
+			pthread_mutex_lock(&r.lock);
+			r.tail = (slot + 1) % r.nbufs;
+			--r.filled;
+			pthread_cond_signal(&r.freed);
+			pthread_mutex_unlock(&r.lock);
+		}
+		pthread_join(tid, NULL);
+		rc = 0;
+		if (r.err) {
+			errno = r.err;
+			rc = -1;
+		}
+	}
+
+	pthread_cond_destroy(&r.freed);
+	pthread_cond_destroy(&r.ready);
+	pthread_mutex_destroy(&r.lock);
+	free(r.lens);
+	free(r.ring);
+	return rc;
+}
+
+#if defined(__linux__)
+/*
+ Both ends are pipes: tee(2) duplicates the data into `out` inside the kernel, so only the read that
+ drains `in` for the hash goes through user space, saving the write-side copy of the plain loop.
+ Returns 1 if tee cannot be used for this pair (the caller continues with the plain loop; everything
+ duplicated so far has been drained and hashed), otherwise as fh_copy_fd.
+ */
+static int fh_copy_tee(int in, int out, const fh_sink *sink, uint8_t *buf) {
+	struct stat si, so;
+	if (fstat(in, &si) != 0 || fstat(out, &so) != 0 || !S_ISFIFO(si.st_mode) || !S_ISFIFO(so.st_mode)) return 1;
+	for (;;) {
+		ssize_t n = tee(in, out, FH_COPY_BUFSIZE, 0);
+		if (n == 0) return 0;
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			if (errno == EINVAL || errno == EAGAIN) return 1; /* unsupported pair or non-blocking end */
+			return (errno == EPIPE) ? -2 : -1;
+		}
+		/* drain exactly what was duplicated, hashing it on the way */
+		size_t left = (size_t)n;
+		while (left > 0) {
+			ssize_t r = read(in, buf, left);
+			if (r < 0 && errno == EINTR) continue;
+			if (r <= 0) {
+				if (r == 0) errno = EIO;
+				return -1;
+			}
+			sink->update(sink->ctx, buf, (size_t)r);
+			left -= (size_t)r;
+		}
+	}
+}
+#endif /* !__linux__ */
+
+int fh_copy_fd(int in, int out, const fh_sink *sink, unsigned flags) {
+	void *mem = NULL;
+	if (posix_memalign(&mem, 4096, FH_COPY_BUFSIZE) != 0) {
+		errno = ENOMEM;
+		return -1;
+	}
+	uint8_t *buf = (uint8_t *)mem;
+	int rc = 0;
+#if defined(__linux__)
+	rc = fh_copy_tee(in, out, sink, buf);
+	if (rc != 1) {
+		int saved = errno;
+		free(mem);
+		errno = saved;
+		return rc;
+	}
+	rc = 0;
+#endif /* !__linux__ */
+	for (;;) {
+		ssize_t r = read(in, buf, FH_COPY_BUFSIZE);
+		if (r == 0) break;
+		if (r < 0) {
+			if (errno == EINTR) continue;
+			rc = -1;
+			break;
+		}
+		/* hash while the block is still hot in cache, then write it out */
+		sink->update(sink->ctx, buf, (size_t)r);
+		size_t off = 0;
+		while (off < (size_t)r) {
+			ssize_t w = write(out, buf + off, (size_t)r - off);
+			if (w < 0) {
+				if (errno == EINTR) continue;
+				rc = -2;
+				break;
+			}
+			off += (size_t)w;
+		}
+		if (rc != 0) break;
+	}
+	if (rc == 0 && (flags & FH_COPY_FSYNC)) {
+		struct stat st;
+		if (fstat(out, &st) == 0 && (S_ISREG(st.st_mode) || S_ISBLK(st.st_mode)) && fsync(out) != 0) rc = -2;
+	}
+	int saved = errno;
+	free(mem);
+	errno = saved;
+	return rc;
+}
+
+int fh_same_file(int a, int b) {
+	struct stat sa, sb;
+	if (fstat(a, &sa) != 0 || fstat(b, &sb) != 0) return 0;
+	/* a terminal or /dev/null on both ends is fine; only a regular file can be clobbered */
+	return S_ISREG(sa.st_mode) && sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino;
+}
+
+int fh_open_copy_dest(int in, const char *path) {
+	/* no O_TRUNC yet: the check below must run before any data is discarded */
+	int fd = open(path, O_WRONLY | O_CREAT, 0666);
+	if (fd < 0) return -1;
+	if (fh_same_file(in, fd)) {
+		close(fd);
+		return FH_SAME_FILE;
+	}
+	struct stat st;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && ftruncate(fd, 0) != 0) {
+		int saved = errno;
+		close(fd);
+		errno = saved;
+		return -1;
+	}
+	return fd;
+}
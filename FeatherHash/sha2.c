@@ -32,6 +32,21 @@
 
 #endif /* !defined(__has_include) */
 
+/* x86-64 kernels are selected at run time; -DFEATHERHASH_NO_SIMD keeps the build scalar-only. */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(FEATHERHASH_NO_SIMD) && defined(__has_include)
+#if __has_include(<immintrin.h>)
+#include <immintrin.h>
+#include <stdlib.h> /* getenv */
+#define HAVE_IMMINTRIN_H 1
+#define FEATHERHASH_X86_SIMD 1
+#define AVX2_TARGET __attribute__((target("avx2,bmi2")))
+#endif /* !__has_include(<immintrin.h>) */
+#endif /* !__x86_64__ */
+
+#ifndef FEATHERHASH_X86_SIMD
+#define FEATHERHASH_X86_SIMD 0
+#endif /* !FEATHERHASH_X86_SIMD */
+
 /* --- Utility macros --- */
 
 uint32_t rotr32(uint32_t x, unsigned n) {
@@ -98,20 +113,249 @@ static void sha256_transform(uint32_t state[8], const uint8_t block[64]) {
 	state[4] += e; state[5] += f; state[6] += g; state[7] += h;
 }
 
+#if FEATHERHASH_X86_SIMD
+/*
+ AVX2 + BMI2 single-stream SHA-256, after the layout of Intel's sha256_rorx: the message
+ schedules of two consecutive blocks are computed together, one block per 128-bit lane, and
+ interleaved with the rorx-based scalar rounds of the first block; the second block's rounds
+ then run from the stored schedule. A trailing odd block is scheduled alongside itself. The two
+ lanes may also carry blocks of two independent messages (see sha256_64B_many).
+ */
+#define ROR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define VROR32(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+#define SHA256_RND(a, b, c, d, e, f, g, h, wk) do { \
+	uint32_t t1_ = (h) + (ROR32((e), 6) ^ ROR32((e), 11) ^ ROR32((e), 25)) + \
+		(((e) & (f)) ^ (~(e) & (g))) + (wk); \
+	uint32_t t2_ = (ROR32((a), 2) ^ ROR32((a), 13) ^ ROR32((a), 22)) + \
+		(((a) & (b)) ^ ((a) & (c)) ^ ((b) & (c))); \
+	(d) += t1_; \
+	(h) = t1_ + t2_; \
+} while (0)
+
+/* Per 128-bit lane: W[t..t+3] from x0 = W[t-16..t-13], x1, x2, x3 = W[t-4..t-1]. */
+AVX2_TARGET static inline __m256i sha256_avx2_schedule(__m256i x0, __m256i x1, __m256i x2, __m256i x3) {
+	__m256i w15 = _mm256_alignr_epi8(x1, x0, 4);
+	__m256i w7 = _mm256_alignr_epi8(x3, x2, 4);
+	__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(VROR32(w15, 7), VROR32(w15, 18)), _mm256_srli_epi32(w15, 3));
+	__m256i part = _mm256_add_epi32(_mm256_add_epi32(x0, s0), w7);
+	/* sigma1 of W[t-2], W[t-1] yields W[t], W[t+1]; those then feed W[t+2], W[t+3] */
+	__m256i w2 = _mm256_shuffle_epi32(x3, _MM_SHUFFLE(3, 2, 3, 2));
+	__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(VROR32(w2, 17), VROR32(w2, 19)), _mm256_srli_epi32(w2, 10));
+	__m256i lo = _mm256_add_epi32(part, s1);
+	w2 = _mm256_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 1, 0));
+	s1 = _mm256_xor_si256(_mm256_xor_si256(VROR32(w2, 17), VROR32(w2, 19)), _mm256_srli_epi32(w2, 10));
+	return _mm256_blend_epi32(lo, _mm256_add_epi32(part, s1), 0xCC);
+}
+
+/* Load 16 bytes of each block into the low and high lanes, as big-endian words. */
+AVX2_TARGET static inline __m256i sha256_avx2_load(const uint8_t *p0, const uint8_t *p1, __m256i bswap) {
+	__m256i v = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)p0));
+	v = _mm256_inserti128_si256(v, _mm_loadu_si128((const __m128i *)p1), 1);
+	return _mm256_shuffle_epi8(v, bswap);
+}
+
+/* Add the round constants for W[t..t+3] and store lane 0 to wk0 and lane 1 to wk1. */
+AVX2_TARGET static inline void sha256_avx2_store(uint32_t *wk0, uint32_t *wk1, __m256i w, int t) {
+	__m256i k = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(K256 + t)));
+	w = _mm256_add_epi32(w, k);
+	_mm_storeu_si128((__m128i *)(wk0 + t), _mm256_castsi256_si128(w));
+	_mm_storeu_si128((__m128i *)(wk1 + t), _mm256_extracti128_si256(w, 1));
+}
+
+AVX2_TARGET static void sha256_avx2_rounds(uint32_t state[8], const uint32_t wk[64]) {
+	uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+	uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+	for (int t = 0; t < 64; t += 8) {
+		SHA256_RND(a, b, c, d, e, f, g, h, wk[t + 0]);
+		SHA256_RND(h, a, b, c, d, e, f, g, wk[t + 1]);
+		SHA256_RND(g, h, a, b, c, d, e, f, wk[t + 2]);
+		SHA256_RND(f, g, h, a, b, c, d, e, wk[t + 3]);
+		SHA256_RND(e, f, g, h, a, b, c, d, wk[t + 4]);
+		SHA256_RND(d, e, f, g, h, a, b, c, wk[t + 5]);
+		SHA256_RND(c, d, e, f, g, h, a, b, wk[t + 6]);
+		SHA256_RND(b, c, d, e, f, g, h, a, wk[t + 7]);
+	}
+	state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+	state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+/*
+ Compress block p0 into s0, then (when `both`) block p1 into s1, from one two-lane schedule.
+ s0 and s1 may be the same state, for two consecutive blocks of one message.
+ */
+AVX2_TARGET static void sha256_avx2_pair(uint32_t s0[8], const uint8_t *p0, uint32_t s1[8], const uint8_t *p1, int both) {
+	const __m256i bswap = _mm256_setr_epi8(
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	uint32_t wk0[64], wk1[64];
+	__m256i x0 = sha256_avx2_load(p0 + 0, p1 + 0, bswap);
+	__m256i x1 = sha256_avx2_load(p0 + 16, p1 + 16, bswap);
+	__m256i x2 = sha256_avx2_load(p0 + 32, p1 + 32, bswap);
+	__m256i x3 = sha256_avx2_load(p0 + 48, p1 + 48, bswap);
+	sha256_avx2_store(wk0, wk1, x0, 0);
+	sha256_avx2_store(wk0, wk1, x1, 4);
+	sha256_avx2_store(wk0, wk1, x2, 8);
+	sha256_avx2_store(wk0, wk1, x3, 12);
+	uint32_t a = s0[0], b = s0[1], c = s0[2], d = s0[3];
+	uint32_t e = s0[4], f = s0[5], g = s0[6], h = s0[7];
+	for (int t = 0; t < 64; t += 8) {
+		if (t < 48) {
+			__m256i n = sha256_avx2_schedule(x0, x1, x2, x3);
+			sha256_avx2_store(wk0, wk1, n, t + 16);
+			x0 = x1; x1 = x2; x2 = x3; x3 = n;
+		}
+		SHA256_RND(a, b, c, d, e, f, g, h, wk0[t + 0]);
+		SHA256_RND(h, a, b, c, d, e, f, g, wk0[t + 1]);
+		SHA256_RND(g, h, a, b, c, d, e, f, wk0[t + 2]);
+		SHA256_RND(f, g, h, a, b, c, d, e, wk0[t + 3]);
+		if (t < 44) {
+			__m256i n = sha256_avx2_schedule(x0, x1, x2, x3);
+			sha256_avx2_store(wk0, wk1, n, t + 20);
+			x0 = x1; x1 = x2; x2 = x3; x3 = n;
+		}
+		SHA256_RND(e, f, g, h, a, b, c, d, wk0[t + 4]);
+		SHA256_RND(d, e, f, g, h, a, b, c, wk0[t + 5]);
+		SHA256_RND(c, d, e, f, g, h, a, b, wk0[t + 6]);
+		SHA256_RND(b, c, d, e, f, g, h, a, wk0[t + 7]);
+	}
+	s0[0] += a; s0[1] += b; s0[2] += c; s0[3] += d;
+	s0[4] += e; s0[5] += f; s0[6] += g; s0[7] += h;
+	if (both) sha256_avx2_rounds(s1, wk1);
+}
+
+AVX2_TARGET static void sha256_blocks_avx2(uint32_t state[8], const uint8_t *data, size_t nblocks) {
+	for (; nblocks >= 2; nblocks -= 2, data += 128) sha256_avx2_pair(state, data, state, data + 64, 1);
+	if (nblocks > 0) sha256_avx2_pair(state, data, state, data, 0);
+}
+
+/*
+ Kernel selection is resolved once per process: the CPU check and the SHA2_SIMD_ENV override are
+ not repeated for every buffered block. Racing first calls all store the same answer.
+ */
+static int sha2_avx2_state = -1;
+
+static int sha2_have_avx2(void) {
+	int v = __atomic_load_n(&sha2_avx2_state, __ATOMIC_RELAXED);
+	if (v < 0) {
+		const char *env = getenv(SHA2_SIMD_ENV);
+		v = !(env && strcmp(env, "0") == 0) &&
+			__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2");
+		__atomic_store_n(&sha2_avx2_state, v, __ATOMIC_RELAXED);
+	}
+	return v;
+}
+#endif /* !FEATHERHASH_X86_SIMD */
+
+static void sha256_blocks_scalar(uint32_t state[8], const uint8_t *data, size_t nblocks) {
+	while (nblocks-- > 0) {
+		sha256_transform(state, data);
+		data += 64;
+	}
+}
+
+#if FEATHERHASH_X86_SIMD
+typedef void (*sha256_blocks_fn)(uint32_t state[8], const uint8_t *data, size_t nblocks);
+
+static void sha256_blocks_resolve(uint32_t state[8], const uint8_t *data, size_t nblocks);
+static sha256_blocks_fn sha256_blocks_impl = sha256_blocks_resolve;
+
+/* First call: pick the kernel, remember it, and run it. */
+static void sha256_blocks_resolve(uint32_t state[8], const uint8_t *data, size_t nblocks) {
+	sha256_blocks_fn fn = sha2_have_avx2() ? sha256_blocks_avx2 : sha256_blocks_scalar;
+	__atomic_store_n(&sha256_blocks_impl, fn, __ATOMIC_RELAXED);
+	fn(state, data, nblocks);
+}
+#endif /* !FEATHERHASH_X86_SIMD */
+
+void sha256_blocks(uint32_t state[8], const uint8_t *data, size_t nblocks) {
+#if FEATHERHASH_X86_SIMD
+	__atomic_load_n(&sha256_blocks_impl, __ATOMIC_RELAXED)(state, data, nblocks);
+#else
+	sha256_blocks_scalar(state, data, nblocks);
+#endif /* !FEATHERHASH_X86_SIMD */
+}
+
+/* Whether a whole block is zero; a branch-free OR so the check costs far less than a compression. */
+static int sha2_block_is_zero(const uint8_t *p, size_t n) {
+	uint64_t acc = 0;
+	for (size_t i = 0; i < n; i += 8) {
+		uint64_t w;
+		memcpy(&w, p + i, sizeof(w));
+		acc |= w;
+	}
+	return acc == 0;
+}
+
+/* An all-zero block has an all-zero message schedule, so only the rounds remain. */
+static void sha256_transform_zero(uint32_t state[8]) {
+#if FEATHERHASH_X86_SIMD
+	if (sha2_have_avx2()) {
+		sha256_avx2_rounds(state, K256);
+		return;
+	}
+#endif /* !FEATHERHASH_X86_SIMD */
+	uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+	uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+	for (int t = 0; t < 64; ++t) {
+		uint32_t temp1 = h + EP1(e) + CH(e,f,g) + K256[t];
+		uint32_t temp2 = EP0(a) + MAJ(a, b, c);
+		h = g; g = f; f = e; e = d + temp1;
+		d = c; c = b; b = a; a = temp1 + temp2;
+	}
+	state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+	state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+/* Runs of data blocks go to sha256_blocks; all-zero blocks (e.g. zero-filled images) take the rounds-only path. */
+static void sha256_absorb(uint32_t state[8], const uint8_t *p, size_t nblocks) {
+	size_t i = 0;
+	while (i < nblocks) {
+		size_t start = i;
+		while (i < nblocks && !sha2_block_is_zero(p + i * 64, 64)) ++i;
+		if (i > start) sha256_blocks(state, p + start * 64, i - start);
+		for (; i < nblocks && sha2_block_is_zero(p + i * 64, 64); ++i) sha256_transform_zero(state);
+	}
+}
+
 void sha256_update(sha256_ctx *c, const void *data, size_t len) {
 	const uint8_t *p = (const uint8_t*)data;
 	c->bitlen += (uint64_t)len * 8;
-	while (len > 0) {
+	if (c->buflen > 0) {
 		size_t take = (64 - c->buflen) < len ? (64 - c->buflen) : len;
 		memcpy(c->buf + c->buflen, p, take);
 		c->buflen += take;
 		p += take;
 		len -= take;
-		if (c->buflen == 64) {
-			sha256_transform(c->state, c->buf);
-			c->buflen = 0;
-		}
+		if (c->buflen < 64) return;
+		sha256_blocks(c->state, c->buf, 1);
+		c->buflen = 0;
+	}
+	/* whole blocks are compressed in place, without staging them in buf */
+	size_t nblocks = len / 64;
+	if (nblocks > 0) {
+		sha256_absorb(c->state, p, nblocks);
+		p += nblocks * 64;
+		len -= nblocks * 64;
 	}
+	if (len > 0) memcpy(c->buf, p, len);
+	c->buflen = len;
+}
+
+void sha256_update_zeros(sha256_ctx *c, uint64_t len) {
+	c->bitlen += len * 8;
+	if (c->buflen > 0) {
+		size_t take = (64 - c->buflen) < len ? (64 - c->buflen) : (size_t)len;
+		memset(c->buf + c->buflen, 0, take);
+		c->buflen += take;
+		len -= take;
+		if (c->buflen < 64) return;
+		sha256_blocks(c->state, c->buf, 1);
+		c->buflen = 0;
+	}
+	for (uint64_t n = len / 64; n > 0; --n) sha256_transform_zero(c->state);
+	c->buflen = (size_t)(len % 64);
+	memset(c->buf, 0, c->buflen);
 }
 
 void sha256_final(sha256_ctx *c, uint8_t out[32]) {
@@ -119,7 +363,7 @@ void sha256_final(sha256_ctx *c, uint8_t out[32]) {
 	c->buf[i++] = 0x80u;
 	if (i > 56) {
 		while (i < 64) c->buf[i++] = 0;
-		sha256_transform(c->state, c->buf);
+		sha256_blocks(c->state, c->buf, 1);
 		i = 0;
 	}
 	while (i < 56) c->buf[i++] = 0;
@@ -129,7 +373,7 @@ void sha256_final(sha256_ctx *c, uint8_t out[32]) {
 		c->buf[63 - j] = (uint8_t)(bitlen_be & 0xFFu);
 		bitlen_be >>= 8;
 	}
-	sha256_transform(c->state, c->buf);
+	sha256_blocks(c->state, c->buf, 1);
 	for (int t = 0; t < 8; ++t) {
 		out[t*4 + 0] = (uint8_t)(c->state[t] >> 24);
 		out[t*4 + 1] = (uint8_t)(c->state[t] >> 16);
@@ -140,6 +384,103 @@ void sha256_final(sha256_ctx *c, uint8_t out[32]) {
 	memset(c, 0, sizeof(*c));
 }
 
+/* --- SHA-256 fixed-size messages (Merkle nodes) --- */
+
+static const uint32_t H256[8] = {
+	0x6a09e667u,0xbb67ae85u,0x3c6ef372u,0xa54ff53au,0x510e527fu,0x9b05688cu,0x1f83d9abu,0x5be0cd19u
+};
+
+/* W[t] + K256[t] of the padding block that follows a 64-byte message (bit length 512). */
+static const uint32_t PAD64_WK[64] = {
+	0xc28a2f98u,0x71374491u,0xb5c0fbcfu,0xe9b5dba5u,0x3956c25bu,0x59f111f1u,0x923f82a4u,0xab1c5ed5u,
+	0xd807aa98u,0x12835b01u,0x243185beu,0x550c7dc3u,0x72be5d74u,0x80deb1feu,0x9bdc06a7u,0xc19bf374u,
+	0x649b69c1u,0xf0fe4786u,0x0fe1edc6u,0x240cf254u,0x4fe9346fu,0x6cc984beu,0x61b9411eu,0x16f988fau,
+	0xf2c65152u,0xa88e5a6du,0xb019fc65u,0xb9d99ec7u,0x9a1231c3u,0xe70eeaa0u,0xfdb1232bu,0xc7353eb0u,
+	0x3069bad5u,0xcb976d5fu,0x5a0f118fu,0xdc1eeefdu,0x0a35b689u,0xde0b7a04u,0x58f4ca9du,0xe15d5b16u,
+	0x007f3e86u,0x37088980u,0xa507ea32u,0x6fab9537u,0x17406110u,0x0d8cd6f1u,0xcdaa3b6du,0xc0bbbe37u,
+	0x83613bdau,0xdb48a363u,0x0b02e931u,0x6fd15ca7u,0x521afacau,0x31338431u,0x6ed41a95u,0x6d437890u,
+	0xc39c91f2u,0x9eccabbdu,0xb5c9a0e6u,0x532fb63cu,0xd2c741c6u,0x07237ea3u,0xa4954b68u,0x4c191d76u
+};
+
+/* Rounds only, from a precomputed W + K schedule. */
+static void sha256_rounds_wk(uint32_t state[8], const uint32_t wk[64]) {
+	uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+	uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+	for (int t = 0; t < 64; ++t) {
+		uint32_t temp1 = h + EP1(e) + CH(e,f,g) + wk[t];
+		uint32_t temp2 = EP0(a) + MAJ(a, b, c);
+		h = g; g = f; f = e; e = d + temp1;
+		d = c; c = b; b = a; a = temp1 + temp2;
+	}
+	state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+	state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+static void sha256_store(const uint32_t state[8], uint8_t out[32]) {
+	for (int t = 0; t < 8; ++t) {
+		out[t*4 + 0] = (uint8_t)(state[t] >> 24);
+		out[t*4 + 1] = (uint8_t)(state[t] >> 16);
+		out[t*4 + 2] = (uint8_t)(state[t] >> 8);
+		out[t*4 + 3] = (uint8_t)(state[t]);
+	}
+}
+
+void sha256_64B(const uint8_t in[64], uint8_t out[32]) {
+	uint32_t state[8];
+	memcpy(state, H256, sizeof(state));
+	sha256_blocks(state, in, 1);
+	sha256_rounds_wk(state, PAD64_WK);
+	sha256_store(state, out);
+}
+
+void sha256_64B_many(const uint8_t *in, size_t n, uint8_t *out) {
+	size_t i = 0;
+#if FEATHERHASH_X86_SIMD
+	if (sha2_have_avx2()) {
+		/* two independent nodes share one two-lane message schedule */
+		for (; i + 2 <= n; i += 2) {
+			uint32_t s0[8], s1[8];
+			memcpy(s0, H256, sizeof(s0));
+			memcpy(s1, H256, sizeof(s1));
+			sha256_avx2_pair(s0, in + i * 64, s1, in + i * 64 + 64, 1);
+			sha256_avx2_rounds(s0, PAD64_WK);
+			sha256_avx2_rounds(s1, PAD64_WK);
+			sha256_store(s0, out + i * 32);
+			sha256_store(s1, out + i * 32 + 32);
+		}
+	}
+#endif /* !FEATHERHASH_X86_SIMD */
+	for (; i < n; ++i) sha256_64B(in + i * 64, out + i * 32);
+}
+
+/* SHA-256 of exactly 32 bytes: one block, padding written directly. */
+static void sha256_32B(const uint8_t in[32], uint8_t out[32]) {
+	uint8_t block[64];
+	memcpy(block, in, 32);
+	block[32] = 0x80u;
+	memset(block + 33, 0, 29);
+	block[62] = 0x01u; /* bit length 256, big-endian */
+	block[63] = 0x00u;
+	uint32_t state[8];
+	memcpy(state, H256, sizeof(state));
+	sha256_blocks(state, block, 1);
+	sha256_store(state, out);
+}
+
+void sha256d(const void *data, size_t len, uint8_t out[32]) {
+	sha256_ctx c;
+	uint8_t inner[32];
+	sha256_init(&c);
+	sha256_update(&c, data, len);
+	sha256_final(&c, inner);
+	sha256_32B(inner, out);
+}
+
+void sha256d_64B_many(const uint8_t *in, size_t n, uint8_t *out) {
+	sha256_64B_many(in, n, out);
+	for (size_t i = 0; i < n; ++i) sha256_32B(out + i * 32, out + i * 32);
+}
+
 /* --- SHA-512 (core used for SHA-512 and SHA-384) --- */
 static const uint64_t K512[80] = {
 	0x428a2f98d728ae22ULL,0x7137449123ef65cdULL,0xb5c0fbcfec4d3b2fULL,0xe9b5dba58189dbbcULL,
@@ -205,24 +546,213 @@ static void sha512_transform(uint64_t state[8], const uint8_t block[128]) {
 	state[6] += g; state[7] += h;
 }
 
-/* Maintain 128-bit bit length via two 64-bit counters */
-void sha512_update(sha512_ctx *c, const void *data, size_t len) {
-	const uint8_t *p = (const uint8_t*)data;
-	/* update 128-bit bit length */
-	uint64_t add_bits = (uint64_t)len * 8;
+#if FEATHERHASH_X86_SIMD
+/*
+ AVX2 + BMI2 single-stream SHA-512, after the layout of Intel's sha512_rorx: the message
+ schedule is computed four words per ymm register, always four rounds ahead of the scalar
+ rounds that consume it, so the vector and integer pipelines overlap. Rotations in the
+ rounds compile to rorx, which leaves the flags and its source register untouched.
+ */
+#define ROR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+#define VROR64(x, n) _mm256_or_si256(_mm256_srli_epi64((x), (n)), _mm256_slli_epi64((x), 64 - (n)))
+
+#define SHA512_RND(a, b, c, d, e, f, g, h, wk) do { \
+	uint64_t t1_ = (h) + (ROR64((e), 14) ^ ROR64((e), 18) ^ ROR64((e), 41)) + \
+		(((e) & (f)) ^ (~(e) & (g))) + (wk); \
+	uint64_t t2_ = (ROR64((a), 28) ^ ROR64((a), 34) ^ ROR64((a), 39)) + \
+		(((a) & (b)) ^ ((a) & (c)) ^ ((b) & (c))); \
+	(d) += t1_; \
+	(h) = t1_ + t2_; \
+} while (0)
+
+/* W[t..t+3] from x0 = W[t-16..t-13], x1 = W[t-12..t-9], x2 = W[t-8..t-5], x3 = W[t-4..t-1]. */
+AVX2_TARGET static inline __m256i sha512_avx2_schedule(__m256i x0, __m256i x1, __m256i x2, __m256i x3) {
+	__m256i w15 = _mm256_alignr_epi8(_mm256_permute2x128_si256(x0, x1, 0x21), x0, 8);
+	__m256i w7 = _mm256_alignr_epi8(_mm256_permute2x128_si256(x2, x3, 0x21), x2, 8);
+	__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(VROR64(w15, 1), VROR64(w15, 8)), _mm256_srli_epi64(w15, 7));
+	__m256i part = _mm256_add_epi64(_mm256_add_epi64(x0, s0), w7);
+	/* sigma1 of W[t-2], W[t-1] yields W[t], W[t+1]; those then feed W[t+2], W[t+3] */
+	__m256i w2 = _mm256_permute4x64_epi64(x3, _MM_SHUFFLE(3, 2, 3, 2));
+	__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(VROR64(w2, 19), VROR64(w2, 61)), _mm256_srli_epi64(w2, 6));
+	__m256i lo = _mm256_add_epi64(part, s1);
+	w2 = _mm256_permute4x64_epi64(lo, _MM_SHUFFLE(1, 0, 1, 0));
+	s1 = _mm256_xor_si256(_mm256_xor_si256(VROR64(w2, 19), VROR64(w2, 61)), _mm256_srli_epi64(w2, 6));
+	return _mm256_blend_epi32(lo, _mm256_add_epi64(part, s1), 0xF0);
+}
+
+AVX2_TARGET static void sha512_blocks_avx2(uint64_t state[8], const uint8_t *data, size_t nblocks) {
+	const __m256i bswap = _mm256_setr_epi8(
+		7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+		7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+	uint64_t a = state[0], b = state[1], c = state[2], d = state[3];
+	uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+	uint64_t wk[80];
+	while (nblocks-- > 0) {
+		__m256i x0 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(data + 0)), bswap);
+		__m256i x1 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(data + 32)), bswap);
+		__m256i x2 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(data + 64)), bswap);
+		__m256i x3 = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(data + 96)), bswap);
+		_mm256_storeu_si256((__m256i *)(wk + 0), _mm256_add_epi64(x0, _mm256_loadu_si256((const __m256i *)(K512 + 0))));
+		_mm256_storeu_si256((__m256i *)(wk + 4), _mm256_add_epi64(x1, _mm256_loadu_si256((const __m256i *)(K512 + 4))));
+		_mm256_storeu_si256((__m256i *)(wk + 8), _mm256_add_epi64(x2, _mm256_loadu_si256((const __m256i *)(K512 + 8))));
+		_mm256_storeu_si256((__m256i *)(wk + 12), _mm256_add_epi64(x3, _mm256_loadu_si256((const __m256i *)(K512 + 12))));
+		for (int t = 0; t < 80; t += 8) {
+			if (t < 64) {
+				__m256i n = sha512_avx2_schedule(x0, x1, x2, x3);
+				_mm256_storeu_si256((__m256i *)(wk + t + 16), _mm256_add_epi64(n, _mm256_loadu_si256((const __m256i *)(K512 + t + 16))));
+				x0 = x1; x1 = x2; x2 = x3; x3 = n;
+			}
+			SHA512_RND(a, b, c, d, e, f, g, h, wk[t + 0]);
+			SHA512_RND(h, a, b, c, d, e, f, g, wk[t + 1]);
+			SHA512_RND(g, h, a, b, c, d, e, f, wk[t + 2]);
+			SHA512_RND(f, g, h, a, b, c, d, e, wk[t + 3]);
+			if (t < 60) {
+				__m256i n = sha512_avx2_schedule(x0, x1, x2, x3);
+				_mm256_storeu_si256((__m256i *)(wk + t + 20), _mm256_add_epi64(n, _mm256_loadu_si256((const __m256i *)(K512 + t + 20))));
+				x0 = x1; x1 = x2; x2 = x3; x3 = n;
+			}
+			SHA512_RND(e, f, g, h, a, b, c, d, wk[t + 4]);
+			SHA512_RND(d, e, f, g, h, a, b, c, wk[t + 5]);
+			SHA512_RND(c, d, e, f, g, h, a, b, wk[t + 6]);
+			SHA512_RND(b, c, d, e, f, g, h, a, wk[t + 7]);
+		}
+		a = (state[0] += a); b = (state[1] += b); c = (state[2] += c); d = (state[3] += d);
+		e = (state[4] += e); f = (state[5] += f); g = (state[6] += g); h = (state[7] += h);
+		data += 128;
+	}
+}
+
+/* Rounds only, from a precomputed W + K schedule (K512 alone for an all-zero block). */
+AVX2_TARGET static void sha512_avx2_rounds(uint64_t state[8], const uint64_t wk[80]) {
+	uint64_t a = state[0], b = state[1], c = state[2], d = state[3];
+	uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+	for (int t = 0; t < 80; t += 8) {
+		SHA512_RND(a, b, c, d, e, f, g, h, wk[t + 0]);
+		SHA512_RND(h, a, b, c, d, e, f, g, wk[t + 1]);
+		SHA512_RND(g, h, a, b, c, d, e, f, wk[t + 2]);
+		SHA512_RND(f, g, h, a, b, c, d, e, wk[t + 3]);
+		SHA512_RND(e, f, g, h, a, b, c, d, wk[t + 4]);
+		SHA512_RND(d, e, f, g, h, a, b, c, wk[t + 5]);
+		SHA512_RND(c, d, e, f, g, h, a, b, wk[t + 6]);
+		SHA512_RND(b, c, d, e, f, g, h, a, wk[t + 7]);
+	}
+	state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+	state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+#endif /* !FEATHERHASH_X86_SIMD */
+
+static void sha512_blocks_scalar(uint64_t state[8], const uint8_t *data, size_t nblocks) {
+	while (nblocks-- > 0) {
+		sha512_transform(state, data);
+		data += 128;
+	}
+}
+
+#if FEATHERHASH_X86_SIMD
+typedef void (*sha512_blocks_fn)(uint64_t state[8], const uint8_t *data, size_t nblocks);
+
+static void sha512_blocks_resolve(uint64_t state[8], const uint8_t *data, size_t nblocks);
+static sha512_blocks_fn sha512_blocks_impl = sha512_blocks_resolve;
+
+/* First call: pick the kernel, remember it, and run it. */
+static void sha512_blocks_resolve(uint64_t state[8], const uint8_t *data, size_t nblocks) {
+	sha512_blocks_fn fn = sha2_have_avx2() ? sha512_blocks_avx2 : sha512_blocks_scalar;
+	__atomic_store_n(&sha512_blocks_impl, fn, __ATOMIC_RELAXED);
+	fn(state, data, nblocks);
+}
+#endif /* !FEATHERHASH_X86_SIMD */
+
+void sha512_blocks(uint64_t state[8], const uint8_t *data, size_t nblocks) {
+#if FEATHERHASH_X86_SIMD
+	__atomic_load_n(&sha512_blocks_impl, __ATOMIC_RELAXED)(state, data, nblocks);
+#else
+	sha512_blocks_scalar(state, data, nblocks);
+#endif /* !FEATHERHASH_X86_SIMD */
+}
+
+/* An all-zero block has an all-zero message schedule, so only the rounds remain. */
+static void sha512_transform_zero(uint64_t state[8]) {
+#if FEATHERHASH_X86_SIMD
+	if (sha2_have_avx2()) {
+		sha512_avx2_rounds(state, K512);
+		return;
+	}
+#endif /* !FEATHERHASH_X86_SIMD */
+	uint64_t a = state[0], b = state[1], c2 = state[2], d = state[3];
+	uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+	for (int t = 0; t < 80; ++t) {
+		uint64_t S1 = rotr64(e, 14) ^ rotr64(e, 18) ^ rotr64(e, 41);
+		uint64_t ch = (e & f) ^ ((~e) & g);
+		uint64_t temp1 = h + S1 + ch + K512[t];
+		uint64_t S0 = rotr64(a, 28) ^ rotr64(a, 34) ^ rotr64(a, 39);
+		uint64_t maj = (a & b) ^ (a & c2) ^ (b & c2);
+		uint64_t temp2 = S0 + maj;
+		h = g; g = f; f = e; e = d + temp1;
+		d = c2; c2 = b; b = a; a = temp1 + temp2;
+	}
+	state[0] += a; state[1] += b; state[2] += c2;
+	state[3] += d; state[4] += e; state[5] += f;
+	state[6] += g; state[7] += h;
+}
+
+/* Add len bytes to the 128-bit bit length kept in two 64-bit counters */
+static void sha512_count(sha512_ctx *c, uint64_t len) {
+	uint64_t add_bits = len << 3;
 	c->bitlen_low += add_bits;
 	if (c->bitlen_low < add_bits) c->bitlen_high += 1;
-	while (len > 0) {
+	c->bitlen_high += len >> 61;
+}
+
+/* SHA-512 counterpart of sha256_absorb. */
+static void sha512_absorb(uint64_t state[8], const uint8_t *p, size_t nblocks) {
+	size_t i = 0;
+	while (i < nblocks) {
+		size_t start = i;
+		while (i < nblocks && !sha2_block_is_zero(p + i * 128, 128)) ++i;
+		if (i > start) sha512_blocks(state, p + start * 128, i - start);
+		for (; i < nblocks && sha2_block_is_zero(p + i * 128, 128); ++i) sha512_transform_zero(state);
+	}
+}
+
+void sha512_update(sha512_ctx *c, const void *data, size_t len) {
+	const uint8_t *p = (const uint8_t*)data;
+	sha512_count(c, (uint64_t)len);
+	if (c->buflen > 0) {
 		size_t take = (128 - c->buflen) < len ? (128 - c->buflen) : len;
 		memcpy(c->buf + c->buflen, p, take);
 		c->buflen += take;
 		p += take;
 		len -= take;
-		if (c->buflen == 128) {
-			sha512_transform(c->state, c->buf);
-			c->buflen = 0;
-		}
+		if (c->buflen < 128) return;
+		sha512_blocks(c->state, c->buf, 1);
+		c->buflen = 0;
+	}
+	/* whole blocks are compressed in place, without staging them in buf */
+	size_t nblocks = len / 128;
+	if (nblocks > 0) {
+		sha512_absorb(c->state, p, nblocks);
+		p += nblocks * 128;
+		len -= nblocks * 128;
+	}
+	if (len > 0) memcpy(c->buf, p, len);
+	c->buflen = len;
+}
+
+void sha512_update_zeros(sha512_ctx *c, uint64_t len) {
+	sha512_count(c, len);
+	if (c->buflen > 0) {
+		size_t take = (128 - c->buflen) < len ? (128 - c->buflen) : (size_t)len;
+		memset(c->buf + c->buflen, 0, take);
+		c->buflen += take;
+		len -= take;
+		if (c->buflen < 128) return;
+		sha512_blocks(c->state, c->buf, 1);
+		c->buflen = 0;
 	}
+	for (uint64_t n = len / 128; n > 0; --n) sha512_transform_zero(c->state);
+	c->buflen = (size_t)(len % 128);
+	memset(c->buf, 0, c->buflen);
 }
 
 void sha512_final(sha512_ctx *c, uint8_t out[64]) {
@@ -231,7 +761,7 @@ void sha512_final(sha512_ctx *c, uint8_t out[64]) {
 	/* If there is not enough room for the 128‑bit length, pad and compress */
 	if (i > 112) {
 		while (i < 128) c->buf[i++] = 0;
-		sha512_transform(c->state, c->buf);
+		sha512_blocks(c->state, c->buf, 1);
 		i = 0;
 	}
 	/* Pad with zeros up to the length field */
@@ -247,7 +777,7 @@ void sha512_final(sha512_ctx *c, uint8_t out[64]) {
 		low >>= 8;
 	}
 	/* Process the final block */
-	sha512_transform(c->state, c->buf);
+	sha512_blocks(c->state, c->buf, 1);
 	/* Produce the 64‑byte digest */
 	for (int t = 0; t < 8; ++t) {
 		uint64_t v = c->state[t];
@@ -263,3 +793,53 @@ void sha512_final(sha512_ctx *c, uint8_t out[64]) {
 	/* Zero the context to avoid leaving data in memory */
 	memset(c, 0, sizeof(*c));
 }
+
+/* W[t] + K512[t] of the padding block that follows a 128-byte message (bit length 1024). */
+static const uint64_t PAD128_WK[80] = {
+	0xc28a2f98d728ae22ULL,0x7137449123ef65cdULL,0xb5c0fbcfec4d3b2fULL,0xe9b5dba58189dbbcULL,
+	0x3956c25bf348b538ULL,0x59f111f1b605d019ULL,0x923f82a4af194f9bULL,0xab1c5ed5da6d8118ULL,
+	0xd807aa98a3030242ULL,0x12835b0145706fbeULL,0x243185be4ee4b28cULL,0x550c7dc3d5ffb4e2ULL,
+	0x72be5d74f27b896fULL,0x80deb1fe3b1696b1ULL,0x9bdc06a725c71235ULL,0xc19bf174cf692a94ULL,
+	0x649b69c19ef14ad2ULL,0xf03e4786384f45f3ULL,0x11c1adc68b8cd5b9ULL,0x240ca1dc77ad9c65ULL,
+	0x3df12c6f5b2b0295ULL,0x6a74852aaeb0e883ULL,0xdcb4cbddcd4a0114ULL,0x36f988da845153c5ULL,
+	0x9b4761d2eea727cbULL,0xad33ee6d37b932c2ULL,0xc143c7fbb90f6167ULL,0x577487c7d5ef1fd6ULL,
+	0xe9250da555d6c804ULL,0x1652326c7c6f319cULL,0x9c73c1308a6abe80ULL,0xedcb859d96f4174fULL,
+	0x05992bbc5302ea46ULL,0xc0515d8c72d32b21ULL,0xe27760859b58b01cULL,0xbd776eecd97e28bfULL,
+	0xfec461e497d05dfbULL,0x8c65848a09b42f15ULL,0x1d93677302646f8dULL,0x71d7625be0029f9bULL,
+	0xed8c8b143b918647ULL,0x5813345c6ddd5e95ULL,0x44837edc639f1da6ULL,0x65309e51db9245d4ULL,
+	0xa4de07e39af7c84cULL,0xea208293cb3b3d17ULL,0x33abda924feb6a30ULL,0x8965f30d8a442337ULL,
+	0x90808dcdb29ea41bULL,0xe2d6d8dad96f92caULL,0xfd690c3258486648ULL,0xddb95f897e662ce2ULL,
+	0x6b2b08dcc03f02bcULL,0x261c68ddf66cc62cULL,0xa4f0eddd57c1364dULL,0xe35537ec1f29acd2ULL,
+	0x27e70659eef7b721ULL,0xdabbb3bf5db9f4c8ULL,0x34436c1241ad0e37ULL,0x0302752801d6306bULL,
+	0xbf77d7d65bedd8cdULL,0xa9871d46c85cd973ULL,0x5fdbae1fae40e068ULL,0x468af1bb676f47b0ULL,
+	0x809520bd379dac58ULL,0x2766590af071ca9cULL,0xff96fca3577ecadeULL,0x1c490d6456b3b489ULL,
+	0xe85734c184192ce6ULL,0x2ba01930bbb71001ULL,0xabe1acaf661e43ebULL,0x120f3b5f15bf003dULL,
+	0xfd7d4cd1515c8209ULL,0x9cfa18c629a0c327ULL,0x7e39ff2d2a3f2faeULL,0x2ff0a5398e575356ULL,
+	0xc9117833006d097eULL,0x09d40c7849733ff8ULL,0x774d7c8f5f3aa6bdULL,0xe04b4161aa09de75ULL
+};
+
+void sha512_128B(const uint64_t iv[8], const uint8_t in[128], uint8_t out[64]) {
+	uint64_t state[8];
+	for (int i = 0; i < 8; ++i) state[i] = iv[i];
+	sha512_blocks(state, in, 1);
+	/* padding block: rounds only, schedule precomputed */
+	uint64_t a = state[0], b = state[1], c2 = state[2], d = state[3];
+	uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+	for (int t = 0; t < 80; ++t) {
+		uint64_t S1 = rotr64(e, 14) ^ rotr64(e, 18) ^ rotr64(e, 41);
+		uint64_t ch = (e & f) ^ ((~e) & g);
+		uint64_t temp1 = h + S1 + ch + PAD128_WK[t];
+		uint64_t S0 = rotr64(a, 28) ^ rotr64(a, 34) ^ rotr64(a, 39);
+		uint64_t maj = (a & b) ^ (a & c2) ^ (b & c2);
+		uint64_t temp2 = S0 + maj;
+		h = g; g = f; f = e; e = d + temp1;
+		d = c2; c2 = b; b = a; a = temp1 + temp2;
+	}
+	state[0] += a; state[1] += b; state[2] += c2;
+	state[3] += d; state[4] += e; state[5] += f;
+	state[6] += g; state[7] += h;
+	for (int t = 0; t < 8; ++t) {
+		uint64_t v = state[t];
+		for (int j = 0; j < 8; ++j) out[t*8 + j] = (uint8_t)(v >> (56 - 8 * j));
+	}
+}
@@ -28,7 +28,10 @@
  The API operates on a caller-allocated sha256_ctx structure, defined as: ``sha256_ctx``.
 
  Thread safety:
- - Each sha256_ctx instance may be used by one thread at a time. The functions do not use global mutable state.
+ - Each sha256_ctx instance may be used by one thread at a time. The only global mutable state is the
+   kernel selection: on x86-64 the first hash checks the CPU and reads ``SHA2_SIMD_ENV`` once, and the
+   answer is cached for the life of the process (concurrent first calls are safe and agree). Changing
+   the environment variable after the first hash has no effect.
 
  Security notes:
  - The implementation zeroes the context in sha256_final to reduce lifetime of sensitive intermediate state.
@@ -171,6 +174,8 @@ void sha256_init(sha256_ctx *c);
  This function may be called multiple times to process streaming data.
  - The function updates the context's internal bit length and buffers partial blocks.
  - When a full 64-byte block is accumulated, it is processed immediately.
+ - Whole blocks that are entirely zero (runs of zeros in disk images, preallocated files, ...)
+   are detected and compressed without computing their message schedule.
  - The caller remains responsible for supplying all message bytes; call ``sha256_final`` to produce the digest.
 
  - Parameter c: Pointer to an initialized ``sha256_ctx``.
@@ -179,6 +184,18 @@ void sha256_init(sha256_ctx *c);
  */
 void sha256_update(sha256_ctx *c, const void *data, size_t len);
 
+/*!
+ Process `len` zero bytes into the running SHA-256 computation without reading any input.
+
+ Equivalent to ``sha256_update`` over a buffer of `len` zeros, but whole zero blocks skip the
+ message schedule entirely (it is all zeros), so hashing holes in sparse files costs only the
+ compression rounds and no I/O or buffer fills.
+
+ - Parameter c: Pointer to an initialized ``sha256_ctx``.
+ - Parameter len: The ``uint64_t`` number of zero bytes to process.
+ */
+void sha256_update_zeros(sha256_ctx *c, uint64_t len);
+
 /*!
  Finalize hashing and write the 32-byte (256-bit) digest in big-endian order to out.
 
@@ -189,16 +206,69 @@ void sha256_update(sha256_ctx *c, const void *data, size_t len);
 */
 void sha256_final(sha256_ctx *c, uint8_t out[32]);
 
+/*!
+ Compress whole 64-byte blocks directly into a raw SHA-256 state.
+
+ This is the block function behind ``sha256_update``, exposed for callers that keep their own
+ buffering and length accounting (e.g. the pooled contexts in ``sha2pool.h``). No padding is applied.
+
+ On x86-64 CPUs with AVX2 and BMI2 a kernel that schedules two blocks at a time is chosen at
+ run time; the result is identical to the portable transform.
+
+ - Parameter state: The eight working state words (A..H).
+ - Parameter data: Pointer to `nblocks` * 64 bytes of message.
+ - Parameter nblocks: The ``size_t`` number of 64-byte blocks to process.
+ */
+void sha256_blocks(uint32_t state[8], const uint8_t *data, size_t nblocks);
+
+/*!
+ SHA-256 of exactly 64 bytes, e.g. a Merkle node made of two child digests.
+
+ The message is one block and its padding block is constant, so the padding block's schedule
+ is precomputed and only its rounds are run.
+
+ - Parameter in: The 64-byte message.
+ - Parameter out: Receives the 32-byte digest.
+ */
+void sha256_64B(const uint8_t in[64], uint8_t out[32]);
+
+/*!
+ Hash `n` independent 64-byte messages: `out[i*32..]` = SHA-256(`in[i*64..]`).
+
+ With the AVX2 kernel two messages share one vectorized message schedule. `out` may alias `in`
+ (each digest is written after its input has been read), which lets a Merkle level be reduced in place.
+ */
+void sha256_64B_many(const uint8_t *in, size_t n, uint8_t *out);
+
+/// Double SHA-256: SHA-256(SHA-256(`data`)), as used by Bitcoin.
+void sha256d(const void *data, size_t len, uint8_t out[32]);
+
+/// ``sha256d`` counterpart of ``sha256_64B_many``; `out` may alias `in`.
+void sha256d_64B_many(const uint8_t *in, size_t n, uint8_t *out);
+
 /* --- Internal notes (for maintainers) ---
  - K256: round constants per FIPS-180-4.
  - sha256_transform: processes a single 512-bit block and updates 'state'.
  - The message schedule w[0..63] is computed in-place; SIG0/SIG1/EP0/EP1/CH/MAJ are provided as macros.
+ - x86-64 AVX2/BMI2 kernels: sha2_have_avx2() checks the CPU and SHA2_SIMD_ENV once per process
+   and caches the answer. Every place that picks a kernel:
+   - sha256_blocks, sha512_blocks: resolved on first use and kept in a static function pointer;
+     sha512_128B reaches the AVX2 kernel through sha512_blocks.
+   - sha256_transform_zero, sha512_transform_zero: all-zero blocks in sha*_update; they ask
+     sha2_have_avx2() themselves and run the AVX2 rounds over K256/K512 (no schedule).
+   - sha256_64B_many (and sha256d_64B_many through it): asks sha2_have_avx2() itself and hashes
+     pairs of nodes on one two-lane schedule; an odd last node goes through sha256_blocks.
+   Build with -DFEATHERHASH_NO_SIMD to compile them out, or set SHA2_SIMD_ENV=0 to force the
+   portable transforms at run time (the test suite runs both).
  - Endianness: input bytes are combined to big-endian 32-bit words in sha256_transform.
  - The implementation appends the 64-bit message length in big-endian as required by the spec.
  - Zeroing the sha256_ctx in sha256_final includes state, counters and buffer to limit exposure of intermediate values.
  - Keep the transform function static/internal to prevent inadvertent external use.
  */
 
+/// Environment variable: set to `0` to use the portable transforms even where AVX2/BMI2 kernels are available.
+#define SHA2_SIMD_ENV "FEATHERHASH_SIMD"
+
 /* SHA-512 core (used for SHA-512 and SHA-384) */
 typedef struct {
 	uint64_t state[8];
@@ -212,6 +282,27 @@ void sha512_init(sha512_ctx *c, const uint64_t iv[8]);
 void sha512_update(sha512_ctx *c, const void *data, size_t len);
 void sha512_final(sha512_ctx *c, uint8_t out[64]);
 
+/// SHA-512 counterpart of ``sha256_update_zeros``.
+void sha512_update_zeros(sha512_ctx *c, uint64_t len);
+
+/*!
+ SHA-512 counterpart of ``sha256_blocks``; processes whole 128-byte blocks.
+
+ On x86-64 CPUs with AVX2 and BMI2 this runs a vectorized-schedule kernel chosen at run time;
+ elsewhere (or when built with `-DFEATHERHASH_NO_SIMD`) it runs the portable transform. Both
+ produce identical results.
+ */
+void sha512_blocks(uint64_t state[8], const uint8_t *data, size_t nblocks);
+
+/*!
+ SHA-512 family digest of exactly 128 bytes (two 64-byte child digests), with a precomputed
+ padding schedule like ``sha256_64B``.
+
+ - Parameter iv: The SHA-512 or SHA-384 initial hash value (as passed to ``sha512_init``); for SHA-384 use the first 48 bytes of `out`.
+ - Parameter out: Receives the full 64-byte output state.
+ */
+void sha512_128B(const uint64_t iv[8], const uint8_t in[128], uint8_t out[64]);
+
 #ifdef __cplusplus
 }
 #endif /* !defined(__cplusplus) */
@@ -253,8 +344,8 @@ void sha512_final(sha512_ctx *c, uint8_t out[64]);
 // W to EP?() with x,y,z helper macros
 #define WTEP(w, x, y, z) ((ROTRIGHT((w), (x)) ^ ROTRIGHT((w), (y))) ^ ROTRIGHT((w), (z)))
 // SHA-2 EPx functions
-#define EP0(n) (WTEP(n,7,18,3))
-#define EP1(n) (WTEP(n,17,19,10))
+#define EP0(n) (WTEP(n,2,13,22))
+#define EP1(n) (WTEP(n,6,11,25))
 // SHA-2 SIGx functions
 #define SIG0(n) (WTSIG(n,7,18,3))
 #define SIG1(n) (WTSIG(n,17,19,10))
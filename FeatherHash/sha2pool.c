@@ -0,0 +1,193 @@
+/* CC0 1.0 Universal - sha2pool.c
+
+ Permission to use, copy, modify, and/or distribute this software for any
+ purpose with or without fee is hereby granted.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+ Slab allocator for SHA-256 streaming contexts (structure-of-arrays layout).
+*/
+#include "sha2pool.h"
+
+#include <stdlib.h> /* aligned_alloc, realloc, free */
+#include <string.h> /* memcpy, memset */
+
+#define POOL_LINE 64
+
+/* Every array is a whole number of cache lines, so each one starts on a line boundary. */
+typedef struct {
+	uint32_t state[SHA256_POOL_SLAB][8];   /* 32 bytes per stream, two streams per line */
+	uint64_t bitlen[SHA256_POOL_SLAB];     /* message bits absorbed so far */
+	uint8_t buflen[SHA256_POOL_SLAB];      /* bytes pending in buf, 0..63 */
+	uint8_t buf[SHA256_POOL_SLAB][64];     /* one partial block per line */
+	uint64_t used;                         /* occupancy bitmap, bit n = lane n */
+	uint8_t pad[POOL_LINE - sizeof(uint64_t)];
+} sha256_slab;
+
+_Static_assert(SHA256_POOL_SLAB == 64, "occupancy bitmap assumes 64 lanes per slab");
+_Static_assert(sizeof(sha256_slab) % POOL_LINE == 0, "slab must be a whole number of lines");
+
+struct sha256_pool {
+	sha256_slab **slabs;
+	size_t nslabs;
+	size_t cap;
+	size_t hint;   /* lowest slab index that may have a free lane */
+};
+
+static const uint32_t SHA256_IV[8] = {
+	0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au,
+	0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u
+};
+
+static unsigned lowest_clear_bit(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+	return (unsigned)__builtin_ctzll(~v);
+#else
+	unsigned n = 0;
+	while (v & 1u) {
+		v >>= 1;
+		++n;
+	}
+	return n;
+#endif
+}
+
+static int pool_grow(sha256_pool *p) {
+	if (p->nslabs == p->cap) {
+		size_t cap = p->cap ? p->cap * 2 : 4;
+		if (cap > (SHA256_POOL_INVALID / SHA256_POOL_SLAB)) return -1;
+		sha256_slab **slabs = (sha256_slab **)realloc(p->slabs, cap * sizeof(*slabs));
+		if (!slabs) return -1;
+		p->slabs = slabs;
+		p->cap = cap;
+	}
+	sha256_slab *s = (sha256_slab *)aligned_alloc(POOL_LINE, sizeof(sha256_slab));
+	if (!s) return -1;
+	memset(s, 0, sizeof(*s));
+	p->slabs[p->nslabs++] = s;
+	return 0;
+}
+
+sha256_pool *sha256_pool_create(size_t capacity_hint) {
+	sha256_pool *p = (sha256_pool *)calloc(1, sizeof(*p));
+	if (!p) return NULL;
+	size_t want = (capacity_hint + SHA256_POOL_SLAB - 1) / SHA256_POOL_SLAB;
+	while (p->nslabs < want) {
+		if (pool_grow(p) != 0) {
+			sha256_pool_destroy(p);
+			return NULL;
+		}
+	}
+	return p;
+}
+
+void sha256_pool_destroy(sha256_pool *p) {
+	if (!p) return;
+	for (size_t i = 0; i < p->nslabs; ++i) {
+		memset(p->slabs[i], 0, sizeof(sha256_slab)); /* drop intermediate state */
+		free(p->slabs[i]);
+	}
+	free(p->slabs);
+	free(p);
+}
+
+sha256_handle sha256_pool_acquire(sha256_pool *p) {
+	size_t i = p->hint;
+	while (i < p->nslabs && p->slabs[i]->used == UINT64_MAX) ++i;
+	if (i == p->nslabs && pool_grow(p) != 0) return SHA256_POOL_INVALID;
+	p->hint = i;
+	sha256_slab *s = p->slabs[i];
+	unsigned lane = lowest_clear_bit(s->used);
+	s->used |= (uint64_t)1 << lane;
+	memcpy(s->state[lane], SHA256_IV, sizeof(SHA256_IV));
+	s->bitlen[lane] = 0;
+	s->buflen[lane] = 0;
+	return (sha256_handle)(i * SHA256_POOL_SLAB + lane);
+}
+
+void sha256_pool_release(sha256_pool *p, sha256_handle h) {
+	size_t i = h / SHA256_POOL_SLAB;
+	unsigned lane = h % SHA256_POOL_SLAB;
+	sha256_slab *s = p->slabs[i];
+	memset(s->state[lane], 0, sizeof(s->state[lane]));
+	memset(s->buf[lane], 0, sizeof(s->buf[lane]));
+	s->bitlen[lane] = 0;
+	s->buflen[lane] = 0;
+	s->used &= ~((uint64_t)1 << lane);
+	if (i < p->hint) p->hint = i;
+}
+
+/* Same buffering as sha256_update, but whole blocks go straight from the caller's memory. */
+static void pool_absorb(sha256_slab *s, unsigned lane, const uint8_t *in, size_t len) {
+	size_t fill = s->buflen[lane];
+	s->bitlen[lane] += (uint64_t)len * 8;
+	if (fill > 0) {
+		size_t take = (64 - fill) < len ? (64 - fill) : len;
+		memcpy(s->buf[lane] + fill, in, take);
+		fill += take;
+		in += take;
+		len -= take;
+		if (fill < 64) {
+			s->buflen[lane] = (uint8_t)fill;
+			return;
+		}
+		sha256_blocks(s->state[lane], s->buf[lane], 1);
+		fill = 0;
+	}
+	size_t nblocks = len / 64;
+	if (nblocks > 0) {
+		sha256_blocks(s->state[lane], in, nblocks);
+		in += nblocks * 64;
+		len -= nblocks * 64;
+	}
+	if (len > 0) memcpy(s->buf[lane], in, len);
+	s->buflen[lane] = (uint8_t)len;
+}
+
+void sha256_pool_update(sha256_pool *p, sha256_handle h, const void *data, size_t len) {
+	if (len == 0) return;
+	pool_absorb(p->slabs[h / SHA256_POOL_SLAB], h % SHA256_POOL_SLAB, (const uint8_t *)data, len);
+}
+
+void sha256_pool_update_many(sha256_pool *p, size_t n, const sha256_handle *handles,
+	const void *const *data, const size_t *lens) {
+	for (size_t k = 0; k < n; ++k) {
+		if (lens[k] == 0) continue;
+		sha256_handle h = handles[k];
+		pool_absorb(p->slabs[h / SHA256_POOL_SLAB], h % SHA256_POOL_SLAB, (const uint8_t *)data[k], lens[k]);
+	}
+}
+
+void sha256_pool_final(sha256_pool *p, sha256_handle h, uint8_t out[32]) {
+	sha256_slab *s = p->slabs[h / SHA256_POOL_SLAB];
+	unsigned lane = h % SHA256_POOL_SLAB;
+	uint8_t *buf = s->buf[lane];
+	uint32_t *state = s->state[lane];
+	size_t i = s->buflen[lane];
+	buf[i++] = 0x80u;
+	if (i > 56) {
+		memset(buf + i, 0, 64 - i);
+		sha256_blocks(state, buf, 1);
+		i = 0;
+	}
+	memset(buf + i, 0, 56 - i);
+	uint64_t bitlen = s->bitlen[lane];
+	for (int j = 0; j < 8; ++j) {
+		buf[63 - j] = (uint8_t)(bitlen & 0xFFu);
+		bitlen >>= 8;
+	}
+	sha256_blocks(state, buf, 1);
+	for (int t = 0; t < 8; ++t) {
+		out[t*4 + 0] = (uint8_t)(state[t] >> 24);
+		out[t*4 + 1] = (uint8_t)(state[t] >> 16);
+		out[t*4 + 2] = (uint8_t)(state[t] >> 8);
+		out[t*4 + 3] = (uint8_t)(state[t]);
+	}
+	sha256_pool_release(p, h);
+}
@@ -0,0 +1,131 @@
+/* CC0 1.0 Universal - sha2tree.c
+
+ Permission to use, copy, modify, and/or distribute this software for any
+ purpose with or without fee is hereby granted.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+ Binary Merkle tree roots over fixed-size leaf digests.
+*/
+#include "sha2tree.h"
+
+#include <pthread.h>
+#include <stdlib.h> /* malloc, free */
+#include <string.h> /* memcpy */
+
+/* Below this many parent nodes per thread a level is not worth splitting. */
+#define TREE_MIN_PER_THREAD 4096
+#define TREE_MAX_THREADS 64
+
+/* Hashes n parents: out[i*node] = H(in[i*2*node .. +2*node]). */
+typedef void (*tree_level_fn)(const uint8_t *in, size_t n, uint8_t *out);
+
+typedef struct {
+	tree_level_fn fn;
+	const uint8_t *in;
+	uint8_t *out;
+	size_t n;
+} tree_job;
+
+static const uint64_t SHA512_IV[8] = {
+	0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+	0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static void sha512_128B_many(const uint8_t *in, size_t n, uint8_t *out) {
+	for (size_t i = 0; i < n; ++i) sha512_128B(SHA512_IV, in + i * 128, out + i * 64);
+}
+
+static void *tree_worker(void *arg) {
+	tree_job *j = (tree_job *)arg;
+	j->fn(j->in, j->n, j->out);
+	return NULL;
+}
+
+/* Hash one level of `parents` nodes, splitting it across up to `nthreads` threads. */
+static void tree_level(tree_level_fn fn, size_t node, const uint8_t *in, size_t parents, uint8_t *out, unsigned nthreads) {
+	size_t nt = parents / TREE_MIN_PER_THREAD;
+	if (nt > nthreads) nt = nthreads;
+	if (nt > TREE_MAX_THREADS) nt = TREE_MAX_THREADS;
+	if (nt < 2) {
+		fn(in, parents, out);
+		return;
+	}
+	pthread_t tid[TREE_MAX_THREADS];
+	tree_job jobs[TREE_MAX_THREADS];
+	int started[TREE_MAX_THREADS];
+	size_t per = parents / nt, extra = parents % nt, first = 0;
+	for (size_t t = 0; t < nt; ++t) {
+		size_t cnt = per + (t < extra ? 1 : 0);
+		jobs[t].fn = fn;
+		jobs[t].in = in + first * 2 * node;
+		jobs[t].out = out + first * node;
+		jobs[t].n = cnt;
+		first += cnt;
+	}
+	/* the calling thread takes the first range */
+	for (size_t t = 1; t < nt; ++t) {
+		started[t] = pthread_create(&tid[t], NULL, tree_worker, &jobs[t]) == 0;
+		if (!started[t]) tree_worker(&jobs[t]);
+	}
+	tree_worker(&jobs[0]);
+	for (size_t t = 1; t < nt; ++t) {
+		if (started[t]) pthread_join(tid[t], NULL);
+	}
+}
+
+static int merkle_root(tree_level_fn fn, size_t node, const uint8_t *leaves, size_t n, unsigned flags, unsigned nthreads, uint8_t *root) {
+	if (n == 0 || !leaves) return -1;
+	if (n == 1) {
+		memcpy(root, leaves, node);
+		return 0;
+	}
+	if (n > SIZE_MAX / node - 1) return -1;
+	/* ping-pong buffers; one spare slot per level for a duplicated odd node */
+	uint8_t *a = (uint8_t *)malloc((n + 1) * node);
+	uint8_t *b = (uint8_t *)malloc((n / 2 + 2) * node);
+	if (!a || !b) {
+		free(a);
+		free(b);
+		return -1;
+	}
+	memcpy(a, leaves, n * node);
+	uint8_t *cur = a, *next = b;
+	while (n > 1) {
+		if ((n & 1u) && (flags & SHA2_MERKLE_DUP_ODD)) {
+			memcpy(cur + n * node, cur + (n - 1) * node, node);
+			++n;
+		}
+		size_t parents = n / 2;
+		tree_level(fn, node, cur, parents, next, nthreads);
+		if (n & 1u) {
+			/* promote the unpaired node unchanged */
+			memcpy(next + parents * node, cur + (n - 1) * node, node);
+			++parents;
+		}
+		uint8_t *t = cur;
+		cur = next;
+		next = t;
+		n = parents;
+	}
+	memcpy(root, cur, node);
+	free(a);
+	free(b);
+	return 0;
+}
+
+int sha256_merkle_root(const uint8_t *leaves, size_t n, unsigned flags, unsigned nthreads, uint8_t root[32]) {
+	tree_level_fn fn = (flags & SHA2_MERKLE_DOUBLE) ? sha256d_64B_many : sha256_64B_many;
+	return merkle_root(fn, 32, leaves, n, flags, nthreads, root);
+}
+
+int sha512_merkle_root(const uint8_t *leaves, size_t n, unsigned flags, unsigned nthreads, uint8_t root[64]) {
+	if (flags & SHA2_MERKLE_DOUBLE) return -1;
+	return merkle_root(sha512_128B_many, 64, leaves, n, flags, nthreads, root);
+}
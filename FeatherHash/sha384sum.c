@@ -13,52 +13,147 @@
 
    Minimal sha384sum command-line utility. Implements SHA-384 by using SHA-512 core
    with SHA-384 initial IV and truncating output to 48 bytes. */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE 1
+#endif /* !_DEFAULT_SOURCE */
 #include "sha2.h"
+#include "featherhashd.h"
+#include "featherio.h"
 #include "feather.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
 static const uint64_t SHA384_IV[8] = {
 	0xcbbb9d5dc1059ed8ULL,0x629a292a367cd507ULL,0x9159015a3070dd17ULL,0x152fecd8f70e5939ULL,
 	0x67332667ffc00b31ULL,0x8eb44a8768581511ULL,0xdb0c2e0d64f98fa7ULL,0x47b5481dbefa4fa4ULL
 };
 
+static void sink_update(void *ctx, const void *data, size_t len) {
+	sha512_update((sha512_ctx *)ctx, data, len);
+}
+
+static void sink_zeros(void *ctx, uint64_t len) {
+	sha512_update_zeros((sha512_ctx *)ctx, len);
+}
+
 static int hash_file_sha384(const char *path, unsigned char out48[48]) {
+	int fd = STDIN_FILENO;
+	int using_stdin = 1;
+	if (path && strcmp(path, "-") != 0) {
+		fd = open(path, O_RDONLY);
+		if (fd < 0) return 1;
+		using_stdin = 0;
+	}
+	/* offload to featherhashd when FEATHERHASHD_SOCKET names a running daemon */
+	int offload = fhd_hash_fd(FHD_ALG_SHA384, fd, out48, 48);
+	if (offload != FHD_UNAVAILABLE) {
+		if (!using_stdin) close(fd);
+		return (offload == 0) ? 0 : 2;
+	}
 	sha512_ctx ctx;
 	sha512_init(&ctx, SHA384_IV);
-	FILE *f = stdin;
-	int using_stdin = 0;
-	if (path && strcmp(path, "-") != 0) {
-		f = fopen(path, "rb");
-		if (!f) return 1;
-	} else {
-		using_stdin = 1;
+	fh_sink sink = { &ctx, sink_update, sink_zeros };
+	static unsigned char buf[65536];
+	int r = fh_hash_fd_overlapped(fd, &sink, buf, sizeof(buf));
+	if (!using_stdin) close(fd);
+	if (r != 0) return 2;
+	unsigned char out64[64];
+	sha512_final(&ctx, out64);
+	memcpy(out48, out64, 48);
+	return 0;
+}
+
+/* Copy src (or stdin) to dest (or stdout) and hash the same bytes in one pass. */
+static int copy_file_sha384(const char *src, const char *dest, unsigned flags, unsigned char out48[48]) {
+	int in = STDIN_FILENO;
+	int out_fd = STDOUT_FILENO;
+	if (src && strcmp(src, "-") != 0) {
+		in = open(src, O_RDONLY);
+		if (in < 0) return 1;
 	}
-	unsigned char buf[8192];
-	size_t r;
-	while ((r = fread(buf, 1, sizeof(buf), f)) > 0) {
-		sha512_update(&ctx, buf, r);
+	if (dest) {
+		out_fd = fh_open_copy_dest(in, dest);
+		if (out_fd < 0) {
+			if (in != STDIN_FILENO) close(in);
+			return (out_fd == FH_SAME_FILE) ? 4 : 3;
+		}
+	} else if (fh_same_file(in, out_fd)) {
+		/* `--tee SRC >> SRC` would keep appending to its own input */
+		if (in != STDIN_FILENO) close(in);
+		return 4;
 	}
-	if (!using_stdin && f) fclose(f);
-	if (ferror(stdin) && using_stdin) return 2;
+	sha512_ctx ctx;
+	sha512_init(&ctx, SHA384_IV);
+	fh_sink sink = { &ctx, sink_update, sink_zeros };
+	int r = fh_copy_fd(in, out_fd, &sink, flags);
+	if (in != STDIN_FILENO) close(in);
+	if (dest && close(out_fd) != 0 && r == 0) r = -2;
+	if (r == -1) return 2;
+	if (r == -2) return 3;
 	unsigned char out64[64];
 	sha512_final(&ctx, out64);
 	memcpy(out48, out64, 48);
 	return 0;
 }
 
-static void print_hex(const unsigned char *d, size_t len) {
-	for (size_t i = 0; i < len; ++i) printf("%02x", d[i]);
+static void print_hex(FILE *f, const unsigned char *d, size_t len) {
+	for (size_t i = 0; i < len; ++i) fprintf(f, "%02x", d[i]);
+}
+
+static int usage(void) {
+	fprintf(stderr, "usage: sha384sum [FILE...]\n");
+	fprintf(stderr, "       sha384sum [--fsync] --copy-to DEST [SRC]\n");
+	fprintf(stderr, "       sha384sum [--fsync] --tee [SRC]    (data to stdout, digest to stderr)\n");
+	return 2;
 }
 
 int main(int argc, char **argv) {
-	if (argc <= 1) {
+	const char *copy_to = NULL;
+	int tee = 0;
+	unsigned copy_flags = 0;
+	int first = 1;
+	for (; first < argc; ++first) {
+		if (strcmp(argv[first], "--copy-to") == 0) {
+			if (first + 1 >= argc) return usage();
+			copy_to = argv[++first];
+		} else if (strcmp(argv[first], "--tee") == 0) {
+			tee = 1;
+		} else if (strcmp(argv[first], "--fsync") == 0) {
+			copy_flags |= FH_COPY_FSYNC;
+		} else if (strcmp(argv[first], "--") == 0) {
+			++first;
+			break;
+		} else {
+			break;
+		}
+	}
+	if (copy_to || tee) {
+		if ((copy_to && tee) || argc - first > 1) return usage();
+		const char *src = (first < argc) ? argv[first] : "-";
+		unsigned char out[48];
+		int r = copy_file_sha384(src, copy_to, copy_flags, out);
+		if (r != 0) {
+			if (r == 3) fprintf(stderr, "sha384sum: %s: cannot write\n", copy_to ? copy_to : "-");
+			else if (r == 4) fprintf(stderr, "sha384sum: %s: input and output are the same file\n", src);
+			else fprintf(stderr, "sha384sum: %s: cannot open/read\n", src);
+			return 2;
+		}
+		/* with --copy-to the line names the copy, as a later `sha384sum DEST` would */
+		print_hex(tee ? stderr : stdout, out, 48);
+		fprintf(tee ? stderr : stdout, "  %s\n", copy_to ? copy_to : src);
+		return 0;
+	}
+	if (copy_flags) return usage();
+	if (first >= argc) {
 		unsigned char out[48];
 		if (hash_file_sha384("-", out) != 0) return 1;
-		print_hex(out, 48);
+		print_hex(stdout, out, 48);
 		printf("  -\n");
 		return 0;
 	}
 	int exitcode = 0;
-	for (int i = 1; i < argc; ++i) {
+	for (int i = first; i < argc; ++i) {
 		unsigned char out[48];
 		int r = hash_file_sha384(argv[i], out);
 		if (r != 0) {
@@ -66,7 +161,7 @@ int main(int argc, char **argv) {
 			exitcode = 2;
 			continue;
 		}
-		print_hex(out, 48);
+		print_hex(stdout, out, 48);
 		printf("  %s\n", argv[i]);
 	}
 	return exitcode;
@@ -30,19 +30,31 @@ DESTDIR_ARG="${3:-}"
 # Build flags (can be overridden by env)
 : "${CFLAGS:=${CFLAGS_ARG:---std=c23 -O2 -ffunction-sections -fdata-sections -fPIC -Wall -Wextra -Werror}}"
 : "${LDFLAGS:=-fuse-ld=lld -Wl}"
+: "${LDLIBS:=-lpthread}"
 
 # Paths (internal)
 SRCDIR="FeatherHash"
 SRC_SHARED="${SRCDIR}/sha2.c"
+SRC_CLIENT="${SRCDIR}/featherhashd_client.c"
+SRC_POOL="${SRCDIR}/sha2pool.c"
+SRC_IO="${SRCDIR}/featherio.c"
+SRC_TREE="${SRCDIR}/sha2tree.c"
 SRC_1="${SRCDIR}/sha256sum.c"
 SRC_2="${SRCDIR}/sha384sum.c"
 SRC_3="${SRCDIR}/sha512sum.c"
+SRC_4="${SRCDIR}/featherhashd.c"
 HDR_1="${SRCDIR}/sha2.h"
 HDR_2="${SRCDIR}/feather.h"
+HDR_3="${SRCDIR}/featherhashd.h"
+HDR_4="${SRCDIR}/sha2pool.h"
+HDR_5="${SRCDIR}/featherio.h"
+HDR_6="${SRCDIR}/sha2tree.h"
 PREFIX="/bin"
 BINNAME_1="sha256sum"
 BINNAME_2="sha384sum"
 BINNAME_3="sha512sum"
+BINNAME_4="featherhashd"
+LIBNAME="libfeatherhash.a"
 
 # DESTDIR safety: default to ./out if not provided
 DESTDIR="${DESTDIR_ARG:-./out}"
@@ -53,13 +65,20 @@ DESTDIR="$(cd "$(dirname "$DESTDIR")" && mkdir -p "$(basename "$DESTDIR")" && cd
 OBJDIR="${DESTDIR}/obj"
 BINDIR="${DESTDIR}/bin"
 INCLUDEDIR="${DESTDIR}/include"
+LIBDIR="${DESTDIR}/lib"
 OUT_BIN_PATH_1="${DESTDIR}${PREFIX}/${BINNAME_1}"
 OUT_BIN_PATH_2="${DESTDIR}${PREFIX}/${BINNAME_2}"
 OUT_BIN_PATH_3="${DESTDIR}${PREFIX}/${BINNAME_3}"
+OUT_BIN_PATH_4="${DESTDIR}${PREFIX}/${BINNAME_4}"
 SHARED_OBJ="${OBJDIR}/sha2.o"
+CLIENT_OBJ="${OBJDIR}/featherhashd_client.o"
+POOL_OBJ="${OBJDIR}/sha2pool.o"
+IO_OBJ="${OBJDIR}/featherio.o"
+TREE_OBJ="${OBJDIR}/sha2tree.o"
 TMPOBJ_1="${OBJDIR}/${BINNAME_1}.o"
 TMPOBJ_2="${OBJDIR}/${BINNAME_2}.o"
 TMPOBJ_3="${OBJDIR}/${BINNAME_3}.o"
+TMPOBJ_4="${OBJDIR}/${BINNAME_4}.o"
 
 # --- Helpers ---
 err() { printf 'ERROR: %s\n' "$*" >&2; exit 1; }
@@ -86,7 +105,7 @@ if [ -d "$DESTDIR" ] && [ -n "${DESTDIR_ARG:-}" ]; then
 	# If user explicitly provided DESTDIR, remove previous contents to ensure hermetic build
 	rm -rf -- "$DESTDIR"
 fi
-mkdir -p -- "$OBJDIR" "$BINDIR" "$INCLUDEDIR"
+mkdir -p -- "$OBJDIR" "$BINDIR" "$INCLUDEDIR" "$LIBDIR"
 
 # Copy header if present (optional)
 if [ -f "$HDR_1" ]; then
@@ -95,6 +114,18 @@ fi
 if [ -f "$HDR_2" ]; then
 	cp -- "$HDR_2" "$INCLUDEDIR/" || err "failed copying header"
 fi
+if [ -f "$HDR_3" ]; then
+	cp -- "$HDR_3" "$INCLUDEDIR/" || err "failed copying header"
+fi
+if [ -f "$HDR_4" ]; then
+	cp -- "$HDR_4" "$INCLUDEDIR/" || err "failed copying header"
+fi
+if [ -f "$HDR_5" ]; then
+	cp -- "$HDR_5" "$INCLUDEDIR/" || err "failed copying header"
+fi
+if [ -f "$HDR_6" ]; then
+	cp -- "$HDR_6" "$INCLUDEDIR/" || err "failed copying header"
+fi
 
 # Source check
 [ -f "$SRC_SHARED" ] || err "source $SRC_SHARED not found"
@@ -105,6 +136,51 @@ printf 'Compiling %s -> %s\n' "$SRC_SHARED" "$SHARED_OBJ"
 # shellcheck disable=SC2086
 $CC $CFLAGS -I"$INCLUDEDIR" -c -o "$SHARED_OBJ" "$SRC_SHARED" || err "compilation failed"
 
+# Source check
+[ -f "$SRC_CLIENT" ] || err "source $SRC_CLIENT not found"
+
+# Compile: explicit include path ensures hermetic headers
+printf 'Compiling %s -> %s\n' "$SRC_CLIENT" "$CLIENT_OBJ"
+# Split flags safely
+# shellcheck disable=SC2086
+$CC $CFLAGS -I"$INCLUDEDIR" -c -o "$CLIENT_OBJ" "$SRC_CLIENT" || err "compilation failed"
+
+# Source check
+[ -f "$SRC_POOL" ] || err "source $SRC_POOL not found"
+
+# Compile: explicit include path ensures hermetic headers
+printf 'Compiling %s -> %s\n' "$SRC_POOL" "$POOL_OBJ"
+# Split flags safely
+# shellcheck disable=SC2086
+$CC $CFLAGS -I"$INCLUDEDIR" -c -o "$POOL_OBJ" "$SRC_POOL" || err "compilation failed"
+
+# Source check
+[ -f "$SRC_IO" ] || err "source $SRC_IO not found"
+
+# Compile: explicit include path ensures hermetic headers
+printf 'Compiling %s -> %s\n' "$SRC_IO" "$IO_OBJ"
+# Split flags safely
+# shellcheck disable=SC2086
+$CC $CFLAGS -I"$INCLUDEDIR" -c -o "$IO_OBJ" "$SRC_IO" || err "compilation failed"
+
+# Source check
+[ -f "$SRC_TREE" ] || err "source $SRC_TREE not found"
+
+# Compile: explicit include path ensures hermetic headers
+printf 'Compiling %s -> %s\n' "$SRC_TREE" "$TREE_OBJ"
+# Split flags safely
+# shellcheck disable=SC2086
+$CC $CFLAGS -I"$INCLUDEDIR" -c -o "$TREE_OBJ" "$SRC_TREE" || err "compilation failed"
+
+# Archive: library objects for embedders (the tools link the objects directly)
+printf 'Archiving -> %s\n' "${LIBDIR}/${LIBNAME}"
+rm -f -- "${LIBDIR}/${LIBNAME}"
+if command_exists "$AR"; then
+	"$AR" rcs "${LIBDIR}/${LIBNAME}" "$SHARED_OBJ" "$POOL_OBJ" "$TREE_OBJ" "$IO_OBJ" "$CLIENT_OBJ" || err "archive failed"
+else
+	warn "archiver '$AR' not found; skipping ${LIBNAME}"
+fi
+
 # Source check
 [ -f "$SRC_1" ] || err "source $SRC_1 not found"
 
@@ -132,19 +208,28 @@ printf 'Compiling %s -> %s\n' "$SRC_3" "$TMPOBJ_3"
 # shellcheck disable=SC2086
 $CC $CFLAGS -I"$INCLUDEDIR" -c -o "$TMPOBJ_3" "$SRC_3" || err "compilation failed"
 
+# Source check
+[ -f "$SRC_4" ] || err "source $SRC_4 not found"
+
+# Compile: explicit include path ensures hermetic headers
+printf 'Compiling %s -> %s\n' "$SRC_4" "$TMPOBJ_4"
+# Split flags safely
+# shellcheck disable=SC2086
+$CC $CFLAGS -I"$INCLUDEDIR" -c -o "$TMPOBJ_4" "$SRC_4" || err "compilation failed"
+
 # Link: attempt static then fallback to dynamic; keep hermetic LDFLAGS if provided
 printf 'Linking -> %s\n' "${BINDIR}/${BINNAME_1}"
 mkdir -p -- "$BINDIR"
 # Try static link first
 set +e
 # shellcheck disable=SC2086
-$CC $TMPOBJ_1 $SHARED_OBJ -o "${BINDIR}/${BINNAME_1}" -static $LDFLAGS
+$CC $TMPOBJ_1 $CLIENT_OBJ $IO_OBJ $SHARED_OBJ -o "${BINDIR}/${BINNAME_1}" -static $LDFLAGS $LDLIBS
 link_status_1=$?
 set -e
 if [ "$link_status_1" -ne 0 ]; then
 	printf 'Static link failed (status %d), retrying dynamic link...\n' "$link_status_1"
 	# shellcheck disable=SC2086
-	$CC $TMPOBJ_1 $SHARED_OBJ -o "${BINDIR}/${BINNAME_1}" $LDFLAGS || err "link failed"
+	$CC $TMPOBJ_1 $CLIENT_OBJ $IO_OBJ $SHARED_OBJ -o "${BINDIR}/${BINNAME_1}" $LDFLAGS $LDLIBS || err "link failed"
 fi
 
 # Link: attempt static then fallback to dynamic; keep hermetic LDFLAGS if provided
@@ -152,13 +237,13 @@ printf 'Linking -> %s\n' "${BINDIR}/${BINNAME_2}"
 # Try static link first
 set +e
 # shellcheck disable=SC2086
-$CC $TMPOBJ_2 $SHARED_OBJ -o "${BINDIR}/${BINNAME_2}" -static $LDFLAGS
+$CC $TMPOBJ_2 $CLIENT_OBJ $IO_OBJ $SHARED_OBJ -o "${BINDIR}/${BINNAME_2}" -static $LDFLAGS $LDLIBS
 link_status_2=$?
 set -e
 if [ "$link_status_2" -ne 0 ]; then
 	printf 'Static link failed (status %d), retrying dynamic link...\n' "$link_status_2"
 	# shellcheck disable=SC2086
-	$CC $TMPOBJ_2 $SHARED_OBJ -o "${BINDIR}/${BINNAME_2}" $LDFLAGS || err "link failed"
+	$CC $TMPOBJ_2 $CLIENT_OBJ $IO_OBJ $SHARED_OBJ -o "${BINDIR}/${BINNAME_2}" $LDFLAGS $LDLIBS || err "link failed"
 fi
 
 # Link: attempt static then fallback to dynamic; keep hermetic LDFLAGS if provided
@@ -166,18 +251,33 @@ printf 'Linking -> %s\n' "${BINDIR}/${BINNAME_3}"
 # Try static link first
 set +e
 # shellcheck disable=SC2086
-$CC $TMPOBJ_3 $SHARED_OBJ -o "${BINDIR}/${BINNAME_3}" -static $LDFLAGS
+$CC $TMPOBJ_3 $CLIENT_OBJ $IO_OBJ $SHARED_OBJ -o "${BINDIR}/${BINNAME_3}" -static $LDFLAGS $LDLIBS
 link_status_3=$?
 set -e
 if [ "$link_status_3" -ne 0 ]; then
 	printf 'Static link failed (status %d), retrying dynamic link...\n' "$link_status_3"
 	# shellcheck disable=SC2086
-	$CC $TMPOBJ_3 $SHARED_OBJ -o "${BINDIR}/${BINNAME_3}" $LDFLAGS || err "link failed"
+	$CC $TMPOBJ_3 $CLIENT_OBJ $IO_OBJ $SHARED_OBJ -o "${BINDIR}/${BINNAME_3}" $LDFLAGS $LDLIBS || err "link failed"
+fi
+
+# Link: attempt static then fallback to dynamic; keep hermetic LDFLAGS if provided
+printf 'Linking -> %s\n' "${BINDIR}/${BINNAME_4}"
+# Try static link first
+set +e
+# shellcheck disable=SC2086
+$CC $TMPOBJ_4 $CLIENT_OBJ $IO_OBJ $SHARED_OBJ -o "${BINDIR}/${BINNAME_4}" -static $LDFLAGS $LDLIBS
+link_status_4=$?
+set -e
+if [ "$link_status_4" -ne 0 ]; then
+	printf 'Static link failed (status %d), retrying dynamic link...\n' "$link_status_4"
+	# shellcheck disable=SC2086
+	$CC $TMPOBJ_4 $CLIENT_OBJ $IO_OBJ $SHARED_OBJ -o "${BINDIR}/${BINNAME_4}" $LDFLAGS $LDLIBS || err "link failed"
 fi
 
 unset link_status_1 ;
 unset link_status_2 ;
 unset link_status_3 ;
+unset link_status_4 ;
 
 # Optionally strip if available
 if command_exists "$STRIP"; then
@@ -191,6 +291,9 @@ if command_exists "$STRIP"; then
 	if ! "$STRIP" "${BINDIR}/${BINNAME_3}" >/dev/null 2>&1; then
 		warn "strip failed; continuing"
 	fi
+	if ! "$STRIP" "${BINDIR}/${BINNAME_4}" >/dev/null 2>&1; then
+		warn "strip failed; continuing"
+	fi
 fi
 
 # Stage install into DESTDIR + PREFIX
@@ -198,9 +301,11 @@ mkdir -p -- "$(dirname "$OUT_BIN_PATH_1")"
 mv -- "${BINDIR}/${BINNAME_1}" "$OUT_BIN_PATH_1" || err "install move failed"
 mv -- "${BINDIR}/${BINNAME_2}" "$OUT_BIN_PATH_2" || err "install move failed"
 mv -- "${BINDIR}/${BINNAME_3}" "$OUT_BIN_PATH_3" || err "install move failed"
+mv -- "${BINDIR}/${BINNAME_4}" "$OUT_BIN_PATH_4" || err "install move failed"
 chmod 0755 "$OUT_BIN_PATH_1"
 chmod 0755 "$OUT_BIN_PATH_2"
 chmod 0755 "$OUT_BIN_PATH_3"
+chmod 0755 "$OUT_BIN_PATH_4"
 
 # Verification: run binary with -q or --help if they exist, but do not modify host PATH.
 printf 'Verification...\n'
@@ -220,8 +325,13 @@ $OUT_BIN_PATH_3 $SRC_1 2>/dev/null || true
 $OUT_BIN_PATH_3 $SRC_2 2>/dev/null || true
 $OUT_BIN_PATH_3 $SRC_3 2>/dev/null || true
 
+printf 'Verifying built FeatherHash %s...\n' $BINNAME_4
+$OUT_BIN_PATH_4 -h 2>/dev/null || true
+
 printf 'Build/install complete.\n'
-printf 'Staged install path:\n %s\n %s\n %s\n' "$OUT_BIN_PATH_1" "$OUT_BIN_PATH_2" "$OUT_BIN_PATH_3"
+printf 'Staged install path:\n %s\n %s\n %s\n %s\n' "$OUT_BIN_PATH_1" "$OUT_BIN_PATH_2" "$OUT_BIN_PATH_3" "$OUT_BIN_PATH_4"
+printf 'Staged library:\n %s\n' "${LIBDIR}/${LIBNAME}"
 printf 'To finalize install,\n copy %s to %s on the target system.\n' "$OUT_BIN_PATH_1" "${PREFIX}/${BINNAME_1}"
 printf ' copy %s to %s on the target system.\n' "$OUT_BIN_PATH_2" "${PREFIX}/${BINNAME_2}"
 printf ' copy %s to %s on the target system.\n' "$OUT_BIN_PATH_3" "${PREFIX}/${BINNAME_3}"
+printf ' copy %s to %s on the target system.\n' "$OUT_BIN_PATH_4" "${PREFIX}/${BINNAME_4}"
@@ -0,0 +1,165 @@
+/* CC0 1.0 Universal - featherhashd.h
+
+ Permission to use, copy, modify, and/or distribute this software for any
+ purpose with or without fee is hereby granted.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+ Wire protocol and thin client for the featherhashd local hashing service.
+*/
+#ifndef FEATHERHASH_DAEMON_H
+
+/*!
+ @header featherhashd.h
+ @discussion
+ featherhashd is a small local service that hashes on behalf of short-lived processes, so that
+ the cost of process startup is paid once instead of once per file. Clients talk to it over a
+ UNIX domain socket using one request per connection:
+ - FHD_OP_PATH: the payload is a path; the daemon opens and hashes the file itself.
+ - FHD_OP_FD: no payload; an open descriptor is passed with SCM_RIGHTS and hashed until EOF.
+ - FHD_OP_BYTES: the payload is the message itself (at most ``FHD_MAX_PAYLOAD`` bytes).
+
+ Both ends are on the same host, so the fixed-size headers are sent in host byte order.
+
+ The daemon answers each request with one ``fhd_response``. Path and descriptor requests may take
+ arbitrarily long, so they are first acknowledged with an ``FHD_STARTED`` response once a worker
+ takes them. The client waits a bounded time for the first response and, if none arrives or the
+ daemon reports ``FHD_ERR_BUSY``, gives up and reports ``FHD_UNAVAILABLE``.
+
+ Client mode is opt-in: the client functions only try the daemon when the environment variable
+ named by ``FHD_SOCKET_ENV`` is set, and report ``FHD_UNAVAILABLE`` otherwise so the caller
+ can fall back to hashing locally.
+
+ Usage example:
+ @code
+ uint8_t digest[32];
+ int r = fhd_hash_fd(FHD_ALG_SHA256, fd, digest, sizeof(digest));
+ if (r == FHD_UNAVAILABLE) {
+	 // hash locally
+ }
+ @endcode
+*/
+
+#if defined(__clang__) && __clang__
+#pragma mark -
+#pragma mark featherhashdHeader
+#endif /* !__clang__ */
+///Defined whenever ``featherhashd.h`` is imported.
+#define FEATHERHASH_DAEMON_H "featherhashd.h"
+
+#include "sha2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* !defined(__cplusplus) */
+
+#if defined(__clang__) && __clang__
+#pragma mark -
+#pragma mark Protocol
+#endif /* !__clang__ */
+
+/// Request/response magic, "FHD1".
+#define FHD_MAGIC 0x46484431u
+
+/// Environment variable holding the daemon socket path (enables client mode).
+#define FHD_SOCKET_ENV "FEATHERHASHD_SOCKET"
+
+/// Socket path used by featherhashd when neither ``-s`` nor ``FHD_SOCKET_ENV`` is given.
+#define FHD_DEFAULT_SOCKET "/tmp/featherhashd.sock"
+
+/// Largest path or inline message accepted in a single request.
+#define FHD_MAX_PAYLOAD (64u * 1024u)
+
+/// Returned by the client functions when the daemon is not configured or not reachable.
+#define FHD_UNAVAILABLE (-1)
+
+enum {
+	FHD_OP_PATH = 1,
+	FHD_OP_FD = 2,
+	FHD_OP_BYTES = 3
+};
+
+enum {
+	FHD_ALG_SHA256 = 1,
+	FHD_ALG_SHA384 = 2,
+	FHD_ALG_SHA512 = 3
+};
+
+/* status codes carried in fhd_response.status */
+enum {
+	FHD_OK = 0,
+	FHD_ERR_PROTO = 1,   /* malformed request */
+	FHD_ERR_OPEN = 2,    /* path could not be opened */
+	FHD_ERR_READ = 3,    /* read error on path or descriptor */
+	FHD_ERR_BUSY = 4,    /* queue full or shutting down; nothing was read */
+	FHD_STARTED = 5      /* interim reply: a worker has taken a path or descriptor request */
+};
+
+typedef struct {
+	uint32_t magic;
+	uint8_t op;         /* FHD_OP_* */
+	uint8_t alg;        /* FHD_ALG_* */
+	uint16_t reserved;  /* must be zero */
+	uint32_t len;       /* payload bytes that follow the header */
+} fhd_request;
+
+typedef struct {
+	uint32_t magic;
+	int32_t status;      /* FHD_OK or FHD_ERR_* */
+	uint32_t digest_len; /* 32, 48 or 64 when status is FHD_OK */
+	uint8_t digest[64];
+} fhd_response;
+
+#if defined(__clang__) && __clang__
+#pragma mark -
+#pragma mark Client Functions
+#endif /* !__clang__ */
+
+/*!
+ Hash everything readable from `fd` (until EOF) through the daemon.
+
+ The descriptor is passed to the daemon with SCM_RIGHTS, so it works for regular files as well as
+ pipes; the caller keeps its own copy and remains responsible for closing it.
+
+ - Parameter alg: One of the ``FHD_ALG_*`` values.
+ - Parameter fd: An open, readable descriptor.
+ - Parameter out: Receives the digest.
+ - Parameter outlen: Size of `out`; must be at least the digest size of `alg`.
+ - Returns: 0 on success, ``FHD_UNAVAILABLE`` if the daemon could not be reached (nothing was
+   consumed from `fd`, so the caller may hash it locally), or a positive ``FHD_ERR_*`` code. This
+   includes a busy daemon and one that does not start the job within a few seconds. Once a worker
+   has started reading, a lost response is reported as ``FHD_ERR_READ`` because the descriptor's
+   offset may already have moved.
+ */
+int fhd_hash_fd(uint8_t alg, int fd, uint8_t *out, size_t outlen);
+
+/*!
+ Ask the daemon to open and hash `path` itself.
+
+ Relative paths are resolved by the daemon, so callers should pass absolute paths.
+
+ - Returns: As ``fhd_hash_fd``.
+ */
+int fhd_hash_path(uint8_t alg, const char *path, uint8_t *out, size_t outlen);
+
+/*!
+ Hash `len` bytes at `data` through the daemon. `len` must not exceed ``FHD_MAX_PAYLOAD``.
+
+ - Returns: As ``fhd_hash_fd``.
+ */
+int fhd_hash_bytes(uint8_t alg, const void *data, size_t len, uint8_t *out, size_t outlen);
+
+/// Digest size in bytes for an ``FHD_ALG_*`` value, or 0 if unknown.
+size_t fhd_digest_len(uint8_t alg);
+
+#ifdef __cplusplus
+}
+#endif /* !defined(__cplusplus) */
+
+#endif /* FEATHERHASH_DAEMON_H */
@@ -0,0 +1,127 @@
+/* CC0 1.0 Universal - featherio.h
+
+ Permission to use, copy, modify, and/or distribute this software for any
+ purpose with or without fee is hereby granted.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+ Shared input handling for the sha*sum utilities and featherhashd.
+*/
+#ifndef FEATHERHASH_IO_H
+
+/*!
+ @header featherio.h
+ @discussion
+ Reads a descriptor to EOF and feeds it to a hash through a small ``fh_sink`` callback table,
+ so the same I/O strategy serves SHA-256, SHA-384 and SHA-512.
+
+ Sparse regular files are walked extent by extent with `SEEK_DATA`/`SEEK_HOLE` where the
+ platform provides them: allocated extents are read, holes are handed to the sink's `zeros`
+ callback without any I/O. Digests are identical to reading the file byte by byte.
+
+ Pipes and sockets can instead be hashed with ``fh_hash_fd_overlapped``: a reader thread keeps
+ the descriptor drained into a ring of large buffers while the calling thread hashes them, so an
+ upstream producer is not stalled while a block is being compressed.
+
+ ``fh_copy_fd`` hashes while copying, for tools that would otherwise write a file and then read
+ it back to verify it.
+*/
+
+#if defined(__clang__) && __clang__
+#pragma mark -
+#pragma mark featherioHeader
+#endif /* !__clang__ */
+///Defined whenever ``featherio.h`` is imported.
+#define FEATHERHASH_IO_H "featherio.h"
+
+#include "sha2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* !defined(__cplusplus) */
+
+/// Destination for hashed input: a context plus its update and zero-run functions.
+typedef struct {
+	void *ctx;
+	void (*update)(void *ctx, const void *data, size_t len);
+	void (*zeros)(void *ctx, uint64_t len);
+} fh_sink;
+
+/*!
+ Feed everything from the current offset of `fd` up to EOF into `sink`.
+
+ - Parameter fd: An open, readable descriptor (regular file, pipe, terminal, ...).
+ - Parameter sink: Receives the data; `sink->zeros` is used for holes in sparse files.
+ - Parameter buf: Caller-provided scratch buffer for reads.
+ - Parameter bufsize: Size of `buf` in bytes.
+ - Returns: 0 on success, -1 on a read error (errno is preserved).
+ */
+int fh_hash_fd(int fd, const fh_sink *sink, uint8_t *buf, size_t bufsize);
+
+/// Environment variable: number of ring buffers for ``fh_hash_fd_overlapped`` (0 or 1 disables the reader thread).
+#define FH_PIPE_BUFFERS_ENV "FEATHERHASH_PIPE_BUFFERS"
+/// Environment variable: size of each ring buffer in bytes; a `K` or `M` suffix is accepted.
+#define FH_PIPE_BUFSIZE_ENV "FEATHERHASH_PIPE_BUFSIZE"
+#define FH_PIPE_BUFFERS_DEFAULT 4
+#define FH_PIPE_BUFSIZE_DEFAULT (1024u * 1024u)
+
+/*!
+ Like ``fh_hash_fd``, but when `fd` is a pipe or socket a dedicated thread reads it into a ring
+ of buffers while the calling thread feeds completed buffers to `sink`.
+
+ The ring's shape comes from ``FH_PIPE_BUFFERS_ENV`` and ``FH_PIPE_BUFSIZE_ENV`` (at most 64 buffers
+ of at most 64 MiB, with the count reduced to keep the whole ring within 256 MiB). Other descriptor
+ types, a ring of fewer than two buffers, or failure to allocate the ring or start the thread
+ all fall back to ``fh_hash_fd`` with `buf`.
+
+ - Returns: 0 on success, -1 on a read error (errno is preserved).
+ */
+int fh_hash_fd_overlapped(int fd, const fh_sink *sink, uint8_t *buf, size_t bufsize);
+
+/// ``fh_copy_fd`` flag: `fsync` the destination before returning (skipped for pipes and terminals).
+#define FH_COPY_FSYNC 1u
+/// Size of the page-aligned buffer ``fh_copy_fd`` allocates.
+#define FH_COPY_BUFSIZE (1024u * 1024u)
+
+/*!
+ Copy `in` to `out` until EOF, feeding every byte written to `sink` from the same buffer, so the
+ destination and its digest are produced in one streaming pass.
+
+ On Linux, when both descriptors are pipes, the data is duplicated into `out` with `tee(2)` inside
+ the kernel and only read back once for hashing, instead of also being written from user space.
+ Other pairs (and pipes `tee` rejects) use the read, hash, write loop.
+
+ - Parameter in: An open, readable descriptor.
+ - Parameter out: An open, writable descriptor (file, pipe, stdout, ...).
+ - Parameter flags: 0 or ``FH_COPY_FSYNC``.
+ - Returns: 0 on success, -1 on a read or allocation error, -2 on a write or `fsync` error
+   (errno is preserved).
+ */
+int fh_copy_fd(int in, int out, const fh_sink *sink, unsigned flags);
+
+/// Returned by ``fh_open_copy_dest`` when the destination is the source file itself.
+#define FH_SAME_FILE (-2)
+
+/// Whether two open descriptors refer to the same regular file (same device and inode).
+int fh_same_file(int a, int b);
+
+/*!
+ Open `path` as the destination of a copy from `in`: created (mode 0666 & ~umask) if missing, and
+ truncated only after checking that it is not the file `in` reads, so a copy onto its own source
+ cannot destroy it.
+
+ - Returns: The descriptor, ``FH_SAME_FILE``, or -1 on an open or truncate error (errno is preserved).
+ */
+int fh_open_copy_dest(int in, const char *path);
+
+#ifdef __cplusplus
+}
+#endif /* !defined(__cplusplus) */
+
+#endif /* FEATHERHASH_IO_H */
@@ -0,0 +1,113 @@
+/* CC0 1.0 Universal - sha2pool.h
+
+ Permission to use, copy, modify, and/or distribute this software for any
+ purpose with or without fee is hereby granted.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+ Pooled SHA-256 contexts for very large numbers of concurrent streams.
+*/
+#ifndef FEATHERHASH_SHA2POOL_H
+
+/*!
+ @header sha2pool.h
+ @discussion
+ A pool of SHA-256 streaming contexts addressed by integer handles instead of pointers to
+ individually allocated ``sha256_ctx`` structures.
+
+ Contexts live in slabs of ``SHA256_POOL_SLAB`` streams. Each slab stores its fields as separate
+ cache-line-aligned arrays (states, bit lengths, buffer fill levels and partial blocks), so
+ that per-stream bookkeeping for a burst of small packets touches a few dense lines rather
+ than one scattered heap object per stream, and no per-stream allocator overhead is paid.
+
+ Thread safety:
+ - A pool may be used by one thread at a time. Use one pool per thread for sharded workloads.
+
+ Usage example:
+ @code
+ sha256_pool *pool = sha256_pool_create(0);
+ sha256_handle h = sha256_pool_acquire(pool);
+ sha256_pool_update(pool, h, data, len);
+ sha256_pool_final(pool, h, digest); // releases h
+ sha256_pool_destroy(pool);
+ @endcode
+*/
+
+#if defined(__clang__) && __clang__
+#pragma mark -
+#pragma mark sha2poolHeader
+#endif /* !__clang__ */
+///Defined whenever ``sha2pool.h`` is imported.
+#define FEATHERHASH_SHA2POOL_H "sha2pool.h"
+
+#include "sha2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* !defined(__cplusplus) */
+
+/// Streams per slab; a handle is (slab index * SHA256_POOL_SLAB + lane).
+#define SHA256_POOL_SLAB 64
+
+/// Returned by ``sha256_pool_acquire`` when no context could be allocated.
+#define SHA256_POOL_INVALID UINT32_MAX
+
+typedef uint32_t sha256_handle;
+typedef struct sha256_pool sha256_pool;
+
+/*!
+ Create an empty pool.
+
+ - Parameter capacity_hint: Expected number of concurrent streams (0 for none); slabs for this
+   many streams are allocated up front.
+ - Returns: The new pool, or `NULL` on allocation failure.
+ */
+sha256_pool *sha256_pool_create(size_t capacity_hint);
+
+/// Free the pool and every slab it owns; outstanding handles become invalid.
+void sha256_pool_destroy(sha256_pool *p);
+
+/*!
+ Obtain a freshly initialized context.
+
+ - Returns: A handle, or ``SHA256_POOL_INVALID`` if the pool could not grow.
+ */
+sha256_handle sha256_pool_acquire(sha256_pool *p);
+
+/// Zero and return a context to the pool without producing a digest.
+void sha256_pool_release(sha256_pool *p, sha256_handle h);
+
+/// Equivalent of ``sha256_update`` for a pooled context.
+void sha256_pool_update(sha256_pool *p, sha256_handle h, const void *data, size_t len);
+
+/*!
+ Advance many pooled contexts in one call.
+
+ Entry `i` feeds `lens[i]` bytes at `data[i]` into `handles[i]`. The same handle may appear more
+ than once; its chunks are absorbed in array order.
+
+ This is a convenience wrapper: the entries are absorbed one after another exactly as by
+ ``sha256_pool_update``, with no multi-lane compression across streams.
+
+ - Parameter n: The ``size_t`` number of entries in each array.
+ */
+void sha256_pool_update_many(sha256_pool *p, size_t n, const sha256_handle *handles,
+	const void *const *data, const size_t *lens);
+
+/*!
+ Equivalent of ``sha256_final`` for a pooled context: writes the 32-byte digest to `out`
+ and releases the handle.
+ */
+void sha256_pool_final(sha256_pool *p, sha256_handle h, uint8_t out[32]);
+
+#ifdef __cplusplus
+}
+#endif /* !defined(__cplusplus) */
+
+#endif /* FEATHERHASH_SHA2POOL_H */
@@ -0,0 +1,85 @@
+/* CC0 1.0 Universal - sha2tree.h
+
+ Permission to use, copy, modify, and/or distribute this software for any
+ purpose with or without fee is hereby granted.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+ Binary Merkle tree roots over fixed-size leaf digests.
+*/
+#ifndef FEATHERHASH_SHA2TREE_H
+
+/*!
+ @header sha2tree.h
+ @discussion
+ Computes the root of a binary hash tree whose leaves are already digests (32 bytes for
+ SHA-256, 64 bytes for SHA-512). Every internal node is the hash of its two children
+ concatenated, so each level is a batch of independent fixed-size messages handed to
+ ``sha256_64B_many`` / ``sha512_128B``.
+
+ The tree is reduced one level at a time. Levels with enough nodes are split into
+ contiguous ranges hashed by worker threads; within a range, the AVX2 kernel (when
+ available) hashes two nodes per message schedule.
+
+ Odd levels: by default the last node is promoted to the next level unchanged. With
+ ``SHA2_MERKLE_DUP_ODD`` it is paired with itself instead (Bitcoin's rule).
+
+ Usage example:
+ @code
+ uint8_t root[32];
+ // leaves: n consecutive 32-byte transaction ids
+ if (sha256_merkle_root(leaves, n, SHA2_MERKLE_BITCOIN, 4, root) != 0) { ... }
+ @endcode
+*/
+
+#if defined(__clang__) && __clang__
+#pragma mark -
+#pragma mark sha2treeHeader
+#endif /* !__clang__ */
+///Defined whenever ``sha2tree.h`` is imported.
+#define FEATHERHASH_SHA2TREE_H "sha2tree.h"
+
+#include "sha2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* !defined(__cplusplus) */
+
+/// Hash internal nodes with double SHA-256 (``sha256d``). SHA-256 trees only.
+#define SHA2_MERKLE_DOUBLE 1u
+/// Pair the last node of an odd level with itself instead of promoting it.
+#define SHA2_MERKLE_DUP_ODD 2u
+/// Bitcoin block Merkle root: double SHA-256 nodes, odd nodes duplicated.
+#define SHA2_MERKLE_BITCOIN (SHA2_MERKLE_DOUBLE | SHA2_MERKLE_DUP_ODD)
+
+/*!
+ Compute the root of a SHA-256 Merkle tree.
+
+ - Parameter leaves: `n` consecutive 32-byte leaf digests, in tree order. Not modified.
+ - Parameter n: The ``size_t`` number of leaves. A single leaf is its own root.
+ - Parameter flags: Any combination of the `SHA2_MERKLE_*` flags.
+ - Parameter nthreads: Maximum number of threads per level (0 or 1 hashes on the calling thread).
+ - Parameter root: Receives the 32-byte root.
+ - Returns: 0 on success, -1 if `n` is 0 or memory could not be allocated.
+ */
+int sha256_merkle_root(const uint8_t *leaves, size_t n, unsigned flags, unsigned nthreads, uint8_t root[32]);
+
+/*!
+ SHA-512 counterpart of ``sha256_merkle_root`` over 64-byte leaves; nodes are SHA-512 of 128 bytes.
+
+ - Parameter flags: ``SHA2_MERKLE_DUP_ODD`` or 0; ``SHA2_MERKLE_DOUBLE`` is rejected.
+ - Returns: 0 on success, -1 on invalid arguments or allocation failure.
+ */
+int sha512_merkle_root(const uint8_t *leaves, size_t n, unsigned flags, unsigned nthreads, uint8_t root[64]);
+
+#ifdef __cplusplus
+}
+#endif /* !defined(__cplusplus) */
+
+#endif /* FEATHERHASH_SHA2TREE_H */
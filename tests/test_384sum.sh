@@ -67,6 +67,63 @@ test_vectors() {
     printf "%s\n" "Mismatch stdin" >&2; return 1
   fi
 
+  # stdin through a small reader ring (wraps many times), and with the reader thread disabled
+  head -c 300001 /dev/urandom > /tmp/fh_pipe
+  os=$(osum /tmp/fh_pipe)
+  fh=$(cat /tmp/fh_pipe | FEATHERHASH_PIPE_BUFFERS=2 FEATHERHASH_PIPE_BUFSIZE=4K "$BINARY" | awk '{print $1}')
+  if [ "$fh" != "$os" ]; then
+    printf "%s\n" "Mismatch overlapped stdin" >&2; return 1
+  fi
+  fh=$(cat /tmp/fh_pipe | FEATHERHASH_PIPE_BUFFERS=1 "$BINARY" | awk '{print $1}')
+  if [ "$fh" != "$os" ]; then
+    printf "%s\n" "Mismatch single-threaded stdin" >&2; return 1
+  fi
+  # an oversized ring request is clamped to the total cap, not wrapped
+  fh=$(cat /tmp/fh_pipe | FEATHERHASH_PIPE_BUFFERS=64 FEATHERHASH_PIPE_BUFSIZE=4096M "$BINARY" | awk '{print $1}')
+  if [ "$fh" != "$os" ]; then
+    printf "%s\n" "Mismatch clamped-ring stdin" >&2; return 1
+  fi
+
+  # hash-while-copy: the copy must be identical and the digest must match it
+  rm -f /tmp/fh_copy
+  fh=$("$BINARY" --fsync --copy-to /tmp/fh_copy /tmp/fh_pipe | awk '{print $1}')
+  if [ "$fh" != "$os" ] || ! cmp -s /tmp/fh_pipe /tmp/fh_copy; then
+    printf "%s\n" "Mismatch --copy-to" >&2; return 1
+  fi
+
+  # copying a file onto itself must be refused and leave it intact
+  cp /tmp/fh_pipe /tmp/fh_copy
+  if "$BINARY" --copy-to /tmp/fh_copy /tmp/fh_copy >/dev/null 2>&1; then
+    printf "%s\n" "--copy-to onto its own source did not fail" >&2; return 1
+  fi
+  if ! cmp -s /tmp/fh_pipe /tmp/fh_copy; then
+    printf "%s\n" "--copy-to onto its own source modified it" >&2; return 1
+  fi
+  if "$BINARY" --tee /tmp/fh_copy >>/tmp/fh_copy 2>/dev/null; then
+    printf "%s\n" "--tee appending to its own source did not fail" >&2; return 1
+  fi
+
+  # tee mode: stdin to stdout, digest on stderr
+  fh=$(cat /tmp/fh_pipe | "$BINARY" --tee 2>&1 >/tmp/fh_copy | awk '{print $1}')
+  if [ "$fh" != "$os" ] || ! cmp -s /tmp/fh_pipe /tmp/fh_copy; then
+    printf "%s\n" "Mismatch --tee" >&2; return 1
+  fi
+  # pipe to pipe, where the copy is duplicated in the kernel with tee(2)
+  fh=$( { cat /tmp/fh_pipe | "$BINARY" --tee | cat >/tmp/fh_copy; } 2>&1 | awk '{print $1}')
+  if [ "$fh" != "$os" ] || ! cmp -s /tmp/fh_pipe /tmp/fh_copy; then
+    printf "%s\n" "Mismatch --tee between pipes" >&2; return 1
+  fi
+
+  # sparse file: leading hole, one data extent, trailing hole
+  rm -f /tmp/fh_sparse
+  printf "sparse-extent" | dd of=/tmp/fh_sparse bs=1 seek=1048677 conv=notrunc >/dev/null 2>&1
+  truncate -s 3145779 /tmp/fh_sparse
+  fh=$("$BINARY" /tmp/fh_sparse | awk '{print $1}')
+  os=$(osum /tmp/fh_sparse)
+  if [ "$fh" != "$os" ]; then
+    printf "%s\n" "Mismatch sparse file" >&2; return 1
+  fi
+
   return 0
 }
 
@@ -80,6 +137,15 @@ cleanup_test_artifacts() {
   if [ -r /tmp/fh_rand ] || [ -e /tmp/fh_rand ]; then
     rm -f /tmp/fh_rand 2>/dev/null ;
   fi
+  if [ -r /tmp/fh_sparse ] || [ -e /tmp/fh_sparse ]; then
+    rm -f /tmp/fh_sparse 2>/dev/null ;
+  fi
+  if [ -r /tmp/fh_pipe ] || [ -e /tmp/fh_pipe ]; then
+    rm -f /tmp/fh_pipe 2>/dev/null ;
+  fi
+  if [ -r /tmp/fh_copy ] || [ -e /tmp/fh_copy ]; then
+    rm -f /tmp/fh_copy 2>/dev/null ;
+  fi
   return 0
 }
 
@@ -0,0 +1,241 @@
+/* CC0 1.0 Universal - test_featherhashd.c
+
+ Permission to use, copy, modify, and/or distribute this software for any
+ purpose with or without fee is hereby granted.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+ Client for the featherhashd requests the sha*sum tools never send.
+ Built and run by test_featherhashd.sh against a daemon on FEATHERHASHD_SOCKET:
+
+   test_featherhashd bytes 256|384|512       print the digest of stdin sent inline
+   test_featherhashd path 256|384|512 FILE   print the digest of FILE opened by the daemon
+   test_featherhashd protocol                malformed requests and concurrent inline requests
+*/
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE 1
+#endif /* !_DEFAULT_SOURCE */
+
+#include "sha2.h"
+#include "featherhashd.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif /* !MSG_NOSIGNAL */
+
+static int failures = 0;
+
+#define CHECK(cond, what) do { \
+	if (!(cond)) { \
+		fprintf(stderr, "FAIL: %s (%s:%d)\n", (what), __FILE__, __LINE__); \
+		failures++; \
+	} \
+} while (0)
+
+static const uint64_t SHA512_IV[8] = {
+	0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+	0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static uint8_t parse_alg(const char *s) {
+	if (strcmp(s, "256") == 0) return FHD_ALG_SHA256;
+	if (strcmp(s, "384") == 0) return FHD_ALG_SHA384;
+	if (strcmp(s, "512") == 0) return FHD_ALG_SHA512;
+	return 0;
+}
+
+static void print_digest(const uint8_t *d, size_t len) {
+	for (size_t i = 0; i < len; ++i) printf("%02x", d[i]);
+	printf("\n");
+}
+
+/* Local digest for FHD_ALG_SHA256 / FHD_ALG_SHA512. */
+static void ref_digest(uint8_t alg, const uint8_t *data, size_t len, uint8_t out[64]) {
+	if (alg == FHD_ALG_SHA256) {
+		sha256_ctx c;
+		sha256_init(&c);
+		sha256_update(&c, data, len);
+		sha256_final(&c, out);
+	} else {
+		sha512_ctx c;
+		sha512_init(&c, SHA512_IV);
+		sha512_update(&c, data, len);
+		sha512_final(&c, out);
+	}
+}
+
+#if defined(__clang__) && __clang__
+#pragma mark -
+#pragma mark Malformed Requests
+#endif /* !__clang__ */
+
+/*
+ Send raw bytes on a fresh connection, optionally closing the write side, and wait for one reply.
+ Returns 1 with `resp` filled, 0 if the daemon closed without replying, -1 on error or timeout.
+ */
+static int raw_request(const void *data, size_t len, int shut, fhd_response *resp) {
+	const char *path = getenv(FHD_SOCKET_ENV);
+	struct sockaddr_un sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sun_family = AF_UNIX;
+	if (!path || strlen(path) >= sizeof(sa.sun_path)) return -1;
+	memcpy(sa.sun_path, path, strlen(path) + 1);
+	int s = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (s < 0) return -1;
+	struct timeval tv = { 10, 0 };
+	(void)setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	if (connect(s, (const struct sockaddr *)&sa, sizeof(sa)) != 0 || send(s, data, len, MSG_NOSIGNAL) != (ssize_t)len) {
+		close(s);
+		return -1;
+	}
+	if (shut) (void)shutdown(s, SHUT_WR);
+	size_t got = 0;
+	while (got < sizeof(*resp)) {
+		ssize_t r = recv(s, (uint8_t *)resp + got, sizeof(*resp) - got, 0);
+		if (r < 0 && errno == EINTR) continue;
+		if (r <= 0) break;
+		got += (size_t)r;
+	}
+	close(s);
+	if (got == sizeof(*resp)) return 1;
+	return (got == 0) ? 0 : -1;
+}
+
+/* A request the daemon must reject with FHD_ERR_PROTO as soon as it is read. */
+static void expect_proto(const fhd_request *req, const void *payload, size_t plen, const char *what) {
+	uint8_t msg[sizeof(fhd_request) + 64];
+	memcpy(msg, req, sizeof(*req));
+	if (plen) memcpy(msg + sizeof(*req), payload, plen);
+	fhd_response resp;
+	int r = raw_request(msg, sizeof(*req) + plen, 0, &resp);
+	CHECK(r == 1 && resp.magic == FHD_MAGIC && resp.status == FHD_ERR_PROTO, what);
+}
+
+/* A request cut short must be dropped without a reply, not hang the daemon. */
+static void expect_dropped(const void *data, size_t len, const char *what) {
+	fhd_response resp;
+	CHECK(raw_request(data, len, 1, &resp) == 0, what);
+}
+
+static void test_malformed(void) {
+	fhd_request req = { 0xdeadbeefu, FHD_OP_BYTES, FHD_ALG_SHA256, 0, 0 };
+	expect_proto(&req, NULL, 0, "bad magic");
+	req = (fhd_request){ FHD_MAGIC, FHD_OP_BYTES, 9, 0, 0 };
+	expect_proto(&req, NULL, 0, "unknown algorithm");
+	req = (fhd_request){ FHD_MAGIC, 7, FHD_ALG_SHA256, 0, 0 };
+	expect_proto(&req, NULL, 0, "unknown op");
+	req = (fhd_request){ FHD_MAGIC, FHD_OP_BYTES, FHD_ALG_SHA256, 1, 0 };
+	expect_proto(&req, NULL, 0, "reserved field set");
+	/* rejected from the header alone; the payload is never sent */
+	req = (fhd_request){ FHD_MAGIC, FHD_OP_BYTES, FHD_ALG_SHA256, 0, FHD_MAX_PAYLOAD + 1 };
+	expect_proto(&req, NULL, 0, "oversized payload");
+	req = (fhd_request){ FHD_MAGIC, FHD_OP_FD, FHD_ALG_SHA256, 0, 0 };
+	expect_proto(&req, NULL, 0, "descriptor request without a descriptor");
+	req = (fhd_request){ FHD_MAGIC, FHD_OP_PATH, FHD_ALG_SHA256, 0, 0 };
+	expect_proto(&req, NULL, 0, "empty path");
+	static const char nul_path[] = "/etc\0passwd";
+	req = (fhd_request){ FHD_MAGIC, FHD_OP_PATH, FHD_ALG_SHA256, 0, sizeof(nul_path) - 1 };
+	expect_proto(&req, nul_path, sizeof(nul_path) - 1, "path with embedded NUL");
+
+	req = (fhd_request){ FHD_MAGIC, FHD_OP_BYTES, FHD_ALG_SHA256, 0, 100 };
+	expect_dropped(&req, sizeof(req) / 2, "truncated header");
+	uint8_t part[sizeof(req) + 10];
+	memcpy(part, &req, sizeof(req));
+	memset(part + sizeof(req), 'x', 10);
+	expect_dropped(part, sizeof(part), "truncated payload");
+
+	uint8_t d[64];
+	CHECK(fhd_hash_path(FHD_ALG_SHA256, "/nonexistent/featherhashd/test", d, sizeof(d)) == FHD_ERR_OPEN, "missing path");
+	static uint8_t big[FHD_MAX_PAYLOAD + 1];
+	CHECK(fhd_hash_bytes(FHD_ALG_SHA256, big, sizeof(big), d, sizeof(d)) == FHD_UNAVAILABLE, "client refuses oversized bytes");
+	CHECK(fhd_hash_bytes(FHD_ALG_SHA512, big, 10, d, 32) == FHD_UNAVAILABLE, "client refuses short output");
+
+	/* the largest accepted payload still works after all of the above */
+	uint8_t ref[64];
+	for (size_t i = 0; i < FHD_MAX_PAYLOAD; ++i) big[i] = (uint8_t)(i * 131u + 7u);
+	CHECK(fhd_hash_bytes(FHD_ALG_SHA256, big, FHD_MAX_PAYLOAD, d, sizeof(d)) == 0, "largest payload");
+	ref_digest(FHD_ALG_SHA256, big, FHD_MAX_PAYLOAD, ref);
+	CHECK(memcmp(d, ref, 32) == 0, "largest payload digest");
+}
+
+#if defined(__clang__) && __clang__
+#pragma mark -
+#pragma mark Inline Batches
+#endif /* !__clang__ */
+
+#define BATCH_THREADS 8
+#define BATCH_REQUESTS 64
+
+/* Many small inline requests at once, so workers take several per trip to the queue. */
+static void *batch_client(void *arg) {
+	size_t t = (size_t)arg;
+	uint8_t msg[600], d[64], ref[64];
+	size_t bad = 0;
+	for (size_t i = 0; i < BATCH_REQUESTS; ++i) {
+		size_t len = (t * 37 + i * 11) % sizeof(msg);
+		for (size_t j = 0; j < len; ++j) msg[j] = (uint8_t)(t ^ (i * 7 + j));
+		uint8_t alg = (i & 1u) ? FHD_ALG_SHA512 : FHD_ALG_SHA256;
+		ref_digest(alg, msg, len, ref);
+		if (fhd_hash_bytes(alg, msg, len, d, sizeof(d)) != 0 || memcmp(d, ref, fhd_digest_len(alg)) != 0) bad++;
+	}
+	return (void *)bad;
+}
+
+static void test_batches(void) {
+	pthread_t tid[BATCH_THREADS];
+	for (size_t t = 0; t < BATCH_THREADS; ++t) {
+		CHECK(pthread_create(&tid[t], NULL, batch_client, (void *)t) == 0, "start batch client");
+	}
+	for (size_t t = 0; t < BATCH_THREADS; ++t) {
+		void *bad = NULL;
+		pthread_join(tid[t], &bad);
+		CHECK(bad == NULL, "concurrent inline requests");
+	}
+}
+
+int main(int argc, char **argv) {
+	if (argc == 2 && strcmp(argv[1], "protocol") == 0) {
+		test_malformed();
+		test_batches();
+		if (failures) {
+			fprintf(stderr, "%d check(s) failed\n", failures);
+			return 1;
+		}
+		return 0;
+	}
+	uint8_t alg = (argc >= 3) ? parse_alg(argv[2]) : 0;
+	uint8_t d[64];
+	int r;
+	if (alg && argc == 3 && strcmp(argv[1], "bytes") == 0) {
+		static uint8_t msg[FHD_MAX_PAYLOAD];
+		size_t len = fread(msg, 1, sizeof(msg), stdin);
+		r = fhd_hash_bytes(alg, msg, len, d, sizeof(d));
+	} else if (alg && argc == 4 && strcmp(argv[1], "path") == 0) {
+		r = fhd_hash_path(alg, argv[3], d, sizeof(d));
+	} else {
+		fprintf(stderr, "usage: test_featherhashd bytes|path 256|384|512 [FILE] | protocol\n");
+		return 2;
+	}
+	if (r != 0) {
+		fprintf(stderr, "test_featherhashd: daemon request failed: %d\n", r);
+		return 1;
+	}
+	print_digest(d, fhd_digest_len(alg));
+	return 0;
+}
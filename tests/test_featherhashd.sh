@@ -0,0 +1,133 @@
+#!/bin/dash
+#
+# Permission to use, copy, modify, and/or distribute this software for any
+# purpose with or without fee is hereby granted.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+# WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+# ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+# WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+# ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+# OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+#
+################################################################################
+# test_featherhashd.sh - compare sha*sum offloaded to featherhashd against openssl
+set -eu
+
+DAEMON=${1:-./out/bin/featherhashd}
+BINDIR=${BINDIR:-./out/bin}
+OPENSSL=${OPENSSL:-openssl}
+OUTDIR=${OUTDIR:-./out}
+CC=${CC:-clang}
+SOCK="/tmp/fh_daemon_$$.sock"
+LOG="/tmp/fh_daemon_$$.log"
+CLIENT="/tmp/fh_daemon_client_$$"
+
+if [ ! -x "$DAEMON" ]; then
+  echo "Binary not found or not executable: $DAEMON" >&2
+  exit 2
+fi
+
+# small test vectors
+test_vectors() {
+  "$DAEMON" -s "$SOCK" -w 2 -v 2>"$LOG" &
+  DAEMON_PID=$!
+  tries=0
+  while [ ! -S "$SOCK" ] && [ "$tries" -lt 50 ]; do
+    sleep 0.1 ; tries=$((tries + 1))
+  done
+  if [ ! -S "$SOCK" ]; then
+    printf "%s\n" "featherhashd did not create $SOCK" >&2; return 1
+  fi
+
+  dd if=/dev/urandom of=/tmp/fh_daemon_rand bs=1k count=70 >/dev/null 2>&1 || head -c 71680 /dev/urandom > /tmp/fh_daemon_rand
+  for alg in 256 384 512; do
+    # file, passed to the daemon as a descriptor
+    fh=$(FEATHERHASHD_SOCKET="$SOCK" "$BINDIR/sha${alg}sum" /tmp/fh_daemon_rand | awk '{print $1}')
+    os=$(${OPENSSL} dgst -sha${alg} /tmp/fh_daemon_rand | awk '{print $2}')
+    if [ "$fh" != "$os" ]; then
+      printf "%s\n" "Mismatch daemon sha${alg} file: fh=$fh os=$os" >&2; return 1
+    fi
+    # stdin pipe, passed to the daemon as a descriptor
+    fh=$(printf "stream-data-1234" | FEATHERHASHD_SOCKET="$SOCK" "$BINDIR/sha${alg}sum" | awk '{print $1}')
+    os=$(printf "stream-data-1234" | ${OPENSSL} dgst -sha${alg} | awk '{print $2}')
+    if [ "$fh" != "$os" ]; then
+      printf "%s\n" "Mismatch daemon sha${alg} stdin: fh=$fh os=$os" >&2; return 1
+    fi
+  done
+
+  # missing file must still be reported by the client
+  if FEATHERHASHD_SOCKET="$SOCK" "$BINDIR/sha256sum" /tmp/fh_daemon_missing >/dev/null 2>&1; then
+    printf "%s\n" "Missing file did not fail" >&2; return 1
+  fi
+
+  # a second daemon must not take over the live socket, nor replace a regular file
+  if "$DAEMON" -s "$SOCK" 2>/dev/null; then
+    printf "%s\n" "Second daemon took over $SOCK" >&2; return 1
+  fi
+  printf "keep" > /tmp/fh_daemon_plain
+  if "$DAEMON" -s /tmp/fh_daemon_plain 2>/dev/null || [ "$(cat /tmp/fh_daemon_plain)" != "keep" ]; then
+    printf "%s\n" "featherhashd replaced a regular file" >&2; return 1
+  fi
+
+  served=$(grep -c 'status=0' "$LOG" || true)
+  if [ "$served" -ne 6 ]; then
+    printf "%s\n" "featherhashd served $served of 6 requests" >&2; return 1
+  fi
+
+  # inline bytes and daemon-opened paths, which the sha*sum tools never send
+  # shellcheck disable=SC2086
+  $CC -O2 -I"$OUTDIR/include" -o "$CLIENT" "${0%/*}/test_featherhashd.c" "$OUTDIR/lib/libfeatherhash.a" -lpthread || return 1
+  for alg in 256 384 512; do
+    fh=$(printf "stream-data-1234" | FEATHERHASHD_SOCKET="$SOCK" "$CLIENT" bytes $alg)
+    os=$(printf "stream-data-1234" | "$BINDIR/sha${alg}sum" | awk '{print $1}')
+    if [ "$fh" != "$os" ]; then
+      printf "%s\n" "Mismatch daemon sha${alg} bytes: fh=$fh cli=$os" >&2; return 1
+    fi
+    fh=$(FEATHERHASHD_SOCKET="$SOCK" "$CLIENT" bytes $alg </dev/null)
+    os=$("$BINDIR/sha${alg}sum" </dev/null | awk '{print $1}')
+    if [ "$fh" != "$os" ]; then
+      printf "%s\n" "Mismatch daemon sha${alg} empty bytes: fh=$fh cli=$os" >&2; return 1
+    fi
+    fh=$(FEATHERHASHD_SOCKET="$SOCK" "$CLIENT" path $alg /tmp/fh_daemon_rand)
+    os=$("$BINDIR/sha${alg}sum" /tmp/fh_daemon_rand | awk '{print $1}')
+    if [ "$fh" != "$os" ]; then
+      printf "%s\n" "Mismatch daemon sha${alg} path: fh=$fh cli=$os" >&2; return 1
+    fi
+  done
+  # malformed and oversized requests, then concurrent inline requests
+  if ! FEATHERHASHD_SOCKET="$SOCK" "$CLIENT" protocol; then
+    printf "%s\n" "featherhashd protocol checks failed" >&2; return 1
+  fi
+
+  kill "$DAEMON_PID" ; wait "$DAEMON_PID" || true
+  DAEMON_PID=""
+
+  # stale socket path: clients must fall back to hashing locally
+  fh=$(FEATHERHASHD_SOCKET="$SOCK" "$BINDIR/sha256sum" /tmp/fh_daemon_rand | awk '{print $1}')
+  os=$(${OPENSSL} dgst -sha256 /tmp/fh_daemon_rand | awk '{print $2}')
+  if [ "$fh" != "$os" ]; then
+    printf "%s\n" "Mismatch local fallback: fh=$fh os=$os" >&2; return 1
+  fi
+
+  return 0
+}
+
+cleanup_test_artifacts() {
+  if [ -n "${DAEMON_PID:-}" ]; then
+    kill "$DAEMON_PID" 2>/dev/null || true ;
+  fi
+  rm -f /tmp/fh_daemon_rand /tmp/fh_daemon_plain "$SOCK" "$LOG" "$CLIENT" 2>/dev/null ;
+  return 0
+}
+
+if test_vectors; then
+  echo "All featherhashd tests passed"
+  cleanup_test_artifacts ;
+  exit 0
+else
+  cleanup_test_artifacts ;
+  echo "featherhashd Tests failed" >&2
+  exit 1
+fi
@@ -37,6 +37,8 @@ test_vectors() {
   dash $(which test_256sum.sh) || return 1;
   dash $(which test_384sum.sh) || return 1;
   dash $(which test_512sum.sh) || return 1;
+  dash $(which test_featherhashd.sh) || return 1;
+  dash $(which test_sha2api.sh) || return 1;
 
   return 0
 }
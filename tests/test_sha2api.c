@@ -0,0 +1,363 @@
+/* CC0 1.0 Universal - test_sha2api.c
+
+ Permission to use, copy, modify, and/or distribute this software for any
+ purpose with or without fee is hereby granted.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+ Library-level checks for the APIs the sha*sum tools do not exercise.
+ Built and run by test_sha2api.sh against out/lib/libfeatherhash.a.
+*/
+#include "sha2.h"
+#include "sha2pool.h"
+#include "sha2tree.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(cond, what) do { \
+	if (!(cond)) { \
+		fprintf(stderr, "FAIL: %s (%s:%d)\n", (what), __FILE__, __LINE__); \
+		failures++; \
+	} \
+} while (0)
+
+/* Deterministic xorshift64 so every run (and every kernel) sees the same data. */
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t rng(void) {
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 7;
+	rng_state ^= rng_state << 17;
+	return rng_state;
+}
+
+static void rng_fill(uint8_t *p, size_t n) {
+	for (size_t i = 0; i < n; ++i) p[i] = (uint8_t)rng();
+}
+
+static const uint64_t SHA512_IV[8] = {
+	0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+	0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static int hex_equal(const uint8_t *d, size_t len, const char *hex) {
+	static const char digits[] = "0123456789abcdef";
+	if (strlen(hex) != len * 2) return 0;
+	for (size_t i = 0; i < len; ++i) {
+		if (hex[2 * i] != digits[d[i] >> 4] || hex[2 * i + 1] != digits[d[i] & 15]) return 0;
+	}
+	return 1;
+}
+
+static void ref_sha256(const void *data, size_t len, uint8_t out[32]) {
+	sha256_ctx c;
+	sha256_init(&c);
+	sha256_update(&c, data, len);
+	sha256_final(&c, out);
+}
+
+#if defined(__clang__) && __clang__
+#pragma mark -
+#pragma mark sha2pool
+#endif /* !__clang__ */
+
+#define POOL_STREAMS 200
+#define POOL_ROUNDS 30
+#define POOL_CHUNK_MAX 300
+
+/* Pooled streams must match independent sha256_ctx streams fed the same chunks. */
+static void test_pool(void) {
+	sha256_pool *pool = sha256_pool_create(0);
+	CHECK(pool != NULL, "pool create");
+	if (!pool) return;
+	static sha256_ctx ref[POOL_STREAMS];
+	sha256_handle h[POOL_STREAMS];
+	uint8_t chunk[POOL_CHUNK_MAX];
+	/* more than three slabs, so the pool has to grow past its first 64 lanes */
+	for (size_t i = 0; i < POOL_STREAMS; ++i) {
+		h[i] = sha256_pool_acquire(pool);
+		CHECK(h[i] != SHA256_POOL_INVALID, "pool acquire");
+		sha256_init(&ref[i]);
+	}
+	for (int round = 0; round < POOL_ROUNDS; ++round) {
+		for (size_t i = 0; i < POOL_STREAMS; ++i) {
+			size_t len = (size_t)(rng() % POOL_CHUNK_MAX);
+			rng_fill(chunk, len);
+			sha256_pool_update(pool, h[i], chunk, len);
+			sha256_update(&ref[i], chunk, len);
+		}
+		/* finish a few streams each round and reuse their lanes (exercises the free-slab hint) */
+		for (size_t k = 0; k < 5; ++k) {
+			size_t i = (size_t)(rng() % POOL_STREAMS);
+			uint8_t a[32], b[32];
+			sha256_pool_final(pool, h[i], a);
+			sha256_final(&ref[i], b);
+			CHECK(memcmp(a, b, 32) == 0, "pool final after reuse");
+			h[i] = sha256_pool_acquire(pool);
+			CHECK(h[i] != SHA256_POOL_INVALID, "pool reacquire");
+			sha256_init(&ref[i]);
+		}
+		/* a released lane that is never finished must not disturb its neighbours */
+		sha256_handle spare = sha256_pool_acquire(pool);
+		sha256_pool_update(pool, spare, chunk, 17);
+		sha256_pool_release(pool, spare);
+	}
+	/* one batch naming the same handle three times: chunks are absorbed in array order */
+	{
+		sha256_handle hs[4] = { h[0], h[1], h[0], h[0] };
+		uint8_t d[4][100];
+		const void *ptrs[4] = { d[0], d[1], d[2], d[3] };
+		size_t lens[4] = { 100, 64, 1, 99 };
+		rng_fill(&d[0][0], sizeof(d));
+		sha256_pool_update_many(pool, 4, hs, ptrs, lens);
+		for (size_t k = 0; k < 4; ++k) sha256_update(&ref[k == 1 ? 1 : 0], ptrs[k], lens[k]);
+	}
+	for (size_t i = 0; i < POOL_STREAMS; ++i) {
+		uint8_t a[32], b[32];
+		sha256_pool_final(pool, h[i], a);
+		sha256_final(&ref[i], b);
+		CHECK(memcmp(a, b, 32) == 0, "pool final");
+	}
+	sha256_pool_destroy(pool);
+}
+
+#if defined(__clang__) && __clang__
+#pragma mark -
+#pragma mark zero blocks
+#endif /* !__clang__ */
+
+/*
+ Whole-block updates take a rounds-only path for all-zero blocks; byte-at-a-time updates only
+ ever compress the internal buffer, so the two must agree on data with scattered zero blocks.
+ */
+static void test_zero_blocks(void) {
+	uint8_t msg[8192];
+	memset(msg, 0, sizeof(msg));
+	for (size_t i = 0; i < sizeof(msg); i += 1000) msg[i] = (uint8_t)(i >> 3);
+	uint8_t a[64], b[64];
+	sha256_ctx c;
+	sha256_init(&c);
+	sha256_update(&c, msg, sizeof(msg));
+	sha256_final(&c, a);
+	sha256_init(&c);
+	for (size_t i = 0; i < sizeof(msg); ++i) sha256_update(&c, msg + i, 1);
+	sha256_final(&c, b);
+	CHECK(memcmp(a, b, 32) == 0, "sha256 zero blocks");
+	/* and against update_zeros for an all-zero run */
+	sha256_init(&c);
+	sha256_update(&c, msg + 1, 999);
+	sha256_final(&c, a);
+	sha256_init(&c);
+	sha256_update_zeros(&c, 999);
+	sha256_final(&c, b);
+	CHECK(memcmp(a, b, 32) == 0, "sha256 update_zeros");
+
+	sha512_ctx d;
+	sha512_init(&d, SHA512_IV);
+	sha512_update(&d, msg, sizeof(msg));
+	sha512_final(&d, a);
+	sha512_init(&d, SHA512_IV);
+	for (size_t i = 0; i < sizeof(msg); ++i) sha512_update(&d, msg + i, 1);
+	sha512_final(&d, b);
+	CHECK(memcmp(a, b, 64) == 0, "sha512 zero blocks");
+}
+
+#if defined(__clang__) && __clang__
+#pragma mark -
+#pragma mark kernels
+#endif /* !__clang__ */
+
+/*
+ Known-answer cross-check of the block kernels. Every message length class (empty, partial
+ blocks, odd and even block counts, long runs) is hashed and the digests are folded into one
+ value computed independently with Python's hashlib. test_sha2api.sh runs this once with the
+ default kernel and once with FEATHERHASH_SIMD=0, so both agree with the same reference.
+ */
+#define KERNEL_SEED 0x0123456789abcdefULL
+#define KERNEL_MSG_MAX 65537
+
+static size_t kernel_len(size_t i) {
+	if (i <= 1100 / 13) return i * 13;
+	return (i == 1100 / 13 + 1) ? 4096 : KERNEL_MSG_MAX;
+}
+#define KERNEL_MSGS (1100 / 13 + 3)
+
+static void test_kernel_sha512(void) {
+	static uint8_t msg[KERNEL_MSG_MAX];
+	rng_state = KERNEL_SEED;
+	sha512_ctx fold, c;
+	uint8_t d[64];
+	sha512_init(&fold, SHA512_IV);
+	for (size_t i = 0; i < KERNEL_MSGS; ++i) {
+		size_t len = kernel_len(i);
+		rng_fill(msg, len);
+		sha512_init(&c, SHA512_IV);
+		sha512_update(&c, msg, len);
+		sha512_final(&c, d);
+		sha512_update(&fold, d, 64);
+	}
+	sha512_final(&fold, d);
+	CHECK(hex_equal(d, 64, "c8e2a06a64b72078666e2672db4dd618a37b287791b75a3cce6e830bd8c9ea1b"
+		"1115c422ae7d4993183638de37f8c88c114fe2e833782a3037fc6b7e6a108f0e"), "sha512 kernel known answer");
+}
+
+static void test_kernel_sha256(void) {
+	static uint8_t msg[KERNEL_MSG_MAX];
+	rng_state = KERNEL_SEED;
+	sha256_ctx fold;
+	uint8_t d[32];
+	sha256_init(&fold);
+	for (size_t i = 0; i < KERNEL_MSGS; ++i) {
+		size_t len = kernel_len(i);
+		rng_fill(msg, len);
+		ref_sha256(msg, len, d);
+		sha256_update(&fold, d, 32);
+	}
+	sha256_final(&fold, d);
+	CHECK(hex_equal(d, 32, "3b8c639a83ad941b5645e73609aba527a19b285f629c6e636d99e6c7e4f62d00"),
+		"sha256 kernel known answer");
+}
+
+#if defined(__clang__) && __clang__
+#pragma mark -
+#pragma mark fixed-size nodes and Merkle trees
+#endif /* !__clang__ */
+
+#define NODES 7 /* odd, so the AVX2 pair loop also hits its single-node tail */
+
+static void test_nodes(void) {
+	uint8_t in[NODES * 128], out[NODES * 32], ref[64];
+	rng_fill(in, sizeof(in));
+
+	for (size_t i = 0; i < NODES; ++i) {
+		sha256_64B(in + i * 64, out);
+		ref_sha256(in + i * 64, 64, ref);
+		CHECK(memcmp(out, ref, 32) == 0, "sha256_64B");
+	}
+	sha256_64B_many(in, NODES, out);
+	for (size_t i = 0; i < NODES; ++i) {
+		ref_sha256(in + i * 64, 64, ref);
+		CHECK(memcmp(out + i * 32, ref, 32) == 0, "sha256_64B_many");
+	}
+	/* output aliasing input, as when a tree level is reduced in place */
+	uint8_t inplace[NODES * 64];
+	memcpy(inplace, in, sizeof(inplace));
+	sha256_64B_many(inplace, NODES, inplace);
+	CHECK(memcmp(inplace, out, sizeof(out)) == 0, "sha256_64B_many in place");
+
+	sha256d_64B_many(in, NODES, out);
+	for (size_t i = 0; i < NODES; ++i) {
+		sha256d(in + i * 64, 64, ref);
+		CHECK(memcmp(out + i * 32, ref, 32) == 0, "sha256d_64B_many");
+	}
+	sha256d("abc", 3, ref);
+	CHECK(hex_equal(ref, 32, "4f8b42c22dd3729b519ba6f68d2da7cc5b2d606d05daed5ad5128cc03e6c6358"), "sha256d abc");
+
+	for (size_t i = 0; i < NODES; ++i) {
+		sha512_ctx c;
+		uint8_t got[64];
+		sha512_init(&c, SHA512_IV);
+		sha512_update(&c, in + i * 128, 128);
+		sha512_final(&c, ref);
+		sha512_128B(SHA512_IV, in + i * 128, got);
+		CHECK(memcmp(got, ref, 64) == 0, "sha512_128B");
+	}
+}
+
+/* Bitcoin block 100000: four transaction ids (display order) and the header's Merkle root. */
+static const char *const BLOCK_100000_TXIDS[4] = {
+	"8c14f0db3df150123e6f3dbbf30f8b955a8249b62ac1d1ff16284aefa3d06d87",
+	"fff2525b8931402dd09222c50775608f75787bd2b87e56995a7bdd30f79702c4",
+	"6359f0868171b1d194cbee1af2f16ea598ae8fad666d9b012c8ed2b79a236ec4",
+	"e9a66845e05d5abc0ad04ec80f774a7e585c6e8db975962d069a522137b80c1d"
+};
+#define BLOCK_100000_ROOT "f3e94742aca4b5ef85488dc37c06c3282295ffec960994b2c0d5ac2a25a95766"
+
+/* Bitcoin prints hashes byte-reversed; parse into internal order. */
+static void parse_reversed(const char *hex, uint8_t out[32]) {
+	for (size_t i = 0; i < 32; ++i) {
+		unsigned v;
+		sscanf(hex + 2 * i, "%2x", &v);
+		out[31 - i] = (uint8_t)v;
+	}
+}
+
+#define TREE_SEED 0xfeedfacecafebeefULL
+#define TREE_MAX_LEAVES 20001 /* large enough that a level is split across threads */
+
+static void test_merkle(void) {
+	static const size_t sizes[] = { 1, 2, 3, 4, 5, 7, 8, 13, 100, 1001, TREE_MAX_LEAVES };
+	static const unsigned flags256[] = { 0, SHA2_MERKLE_DUP_ODD, SHA2_MERKLE_DOUBLE, SHA2_MERKLE_BITCOIN };
+	static const unsigned flags512[] = { 0, SHA2_MERKLE_DUP_ODD };
+	uint8_t *leaves = (uint8_t *)malloc((size_t)TREE_MAX_LEAVES * 64);
+	CHECK(leaves != NULL, "malloc");
+	if (!leaves) return;
+
+	uint8_t root[64], mt[64];
+	for (size_t i = 0; i < 4; ++i) parse_reversed(BLOCK_100000_TXIDS[i], leaves + i * 32);
+	CHECK(sha256_merkle_root(leaves, 4, SHA2_MERKLE_BITCOIN, 1, root) == 0, "bitcoin root");
+	for (size_t i = 0; i < 16; ++i) {
+		uint8_t t = root[i];
+		root[i] = root[31 - i];
+		root[31 - i] = t;
+	}
+	CHECK(hex_equal(root, 32, BLOCK_100000_ROOT), "bitcoin block 100000 root");
+
+	CHECK(sha256_merkle_root(leaves, 0, 0, 1, root) == -1, "empty tree");
+	CHECK(sha512_merkle_root(leaves, 4, SHA2_MERKLE_DOUBLE, 1, root) == -1, "sha512 double rejected");
+
+	/* roots for every size and flag set, folded into one value computed with Python's hashlib */
+	sha256_ctx fold256;
+	sha512_ctx fold512;
+	sha256_init(&fold256);
+	sha512_init(&fold512, SHA512_IV);
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+		size_t n = sizes[s];
+		rng_state = TREE_SEED;
+		rng_fill(leaves, n * 32);
+		for (size_t f = 0; f < sizeof(flags256) / sizeof(flags256[0]); ++f) {
+			CHECK(sha256_merkle_root(leaves, n, flags256[f], 1, root) == 0, "sha256 root");
+			CHECK(sha256_merkle_root(leaves, n, flags256[f], 4, mt) == 0, "sha256 root threaded");
+			CHECK(memcmp(root, mt, 32) == 0, "sha256 root threaded vs single");
+			sha256_update(&fold256, root, 32);
+		}
+		rng_state = TREE_SEED;
+		rng_fill(leaves, n * 64);
+		for (size_t f = 0; f < sizeof(flags512) / sizeof(flags512[0]); ++f) {
+			CHECK(sha512_merkle_root(leaves, n, flags512[f], 1, root) == 0, "sha512 root");
+			CHECK(sha512_merkle_root(leaves, n, flags512[f], 4, mt) == 0, "sha512 root threaded");
+			CHECK(memcmp(root, mt, 64) == 0, "sha512 root threaded vs single");
+			sha512_update(&fold512, root, 64);
+		}
+	}
+	sha256_final(&fold256, root);
+	CHECK(hex_equal(root, 32, "9f31fede72ef0b92ca96190e4a864aacbb099fc92bcdec084c41064acf9d749c"), "sha256 merkle known answer");
+	sha512_final(&fold512, root);
+	CHECK(hex_equal(root, 64, "110bcc6b54b0ca5ec59739fc157a5f32c4e69cdf624d2b7d4dd1e094c7443cf1"
+		"7e4d3eb2544b0b5864db13222c9d0879fadc2151c3fd722b82a96bbd0904a90e"), "sha512 merkle known answer");
+	free(leaves);
+}
+
+int main(void) {
+	test_kernel_sha256();
+	test_kernel_sha512();
+	test_pool();
+	test_zero_blocks();
+	test_nodes();
+	test_merkle();
+	if (failures) {
+		fprintf(stderr, "%d check(s) failed\n", failures);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,51 @@
+#!/bin/dash
+#
+# Permission to use, copy, modify, and/or distribute this software for any
+# purpose with or without fee is hereby granted.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+# WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+# ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+# WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+# ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+# OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+#
+################################################################################
+# test_sha2api.sh - build test_sha2api.c against libfeatherhash.a and run it
+set -eu
+
+OUTDIR=${1:-./out}
+# same default compiler as build-featherHash.sh, which built the library
+CC=${CC:-clang}
+SRC="${0%/*}/test_sha2api.c"
+PROG="/tmp/fh_sha2api_$$"
+
+if [ ! -f "$OUTDIR/lib/libfeatherhash.a" ]; then
+  echo "Library not found: $OUTDIR/lib/libfeatherhash.a" >&2
+  exit 2
+fi
+
+test_vectors() {
+  # shellcheck disable=SC2086
+  $CC -O2 -I"$OUTDIR/include" -o "$PROG" "$SRC" "$OUTDIR/lib/libfeatherhash.a" -lpthread || return 1
+  "$PROG" || return 1
+  # again on the portable transforms, in case the default above picked the AVX2 kernels
+  FEATHERHASH_SIMD=0 "$PROG" || return 1
+  return 0
+}
+
+cleanup_test_artifacts() {
+  rm -f "$PROG" 2>/dev/null ;
+  return 0
+}
+
+if test_vectors; then
+  echo "All sha2 API tests passed"
+  cleanup_test_artifacts ;
+  exit 0
+else
+  cleanup_test_artifacts ;
+  echo "sha2 API Tests failed" >&2
+  exit 1
+fi